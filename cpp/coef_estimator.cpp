@@ -0,0 +1,67 @@
+#include "coef_estimator.h"
+#include <cmath>
+#include <algorithm>
+
+CoefEstimator::CoefEstimator(double forget, double gate, double floor)
+  : power(0.0), drag(0.0), accepted(0), rejected(0),
+    forget(forget), gate(gate), floor(floor),
+    svv(0.0), svt(0.0), stt(0.0), svy(0.0), sty(0.0),
+    det(0.0), resvar(0.0), streak(0), trial(0)
+{
+}
+
+bool CoefEstimator::add(double speed, double next, double throttle) {
+  double e = next - predict(speed, throttle);
+  if (accepted > 2 && std::abs(e) > std::max(floor, gate * std::sqrt(resvar))) {
+    if (trial == 0 || ++streak < RESTART) {
+      rejected++;
+      return false;
+    }
+    // the restored fit is not this race's, start over from this tick
+    restore(state());
+  }
+  streak = 0;
+  if (trial > 0)
+    trial--;
+  if (accepted > 2)
+    resvar += (e * e - resvar) / std::min(accepted, 100);
+
+  svv = forget * svv + speed * speed;
+  svt = forget * svt + speed * throttle;
+  stt = forget * stt + throttle * throttle;
+  svy = forget * svy + speed * next;
+  sty = forget * sty + throttle * next;
+  accepted++;
+  solve();
+  return true;
+}
+
+CoefEstimator::state CoefEstimator::save() const {
+  return state { svv, svt, stt, svy, sty, resvar, accepted };
+}
+
+void CoefEstimator::restore(const state& s) {
+  svv = s.svv;
+  svt = s.svt;
+  stt = s.stt;
+  svy = s.svy;
+  sty = s.sty;
+  resvar = s.resvar;
+  accepted = s.accepted;
+  det = 0.0;
+  power = drag = 0.0;
+  streak = 0;
+  trial = accepted > 0 ? RESTART : 0;
+  solve();
+}
+
+void CoefEstimator::solve() {
+  // svv * drag + svt * power = svy and svt * drag + stt * power = sty,
+  // by Cramer's rule for drag and then power from the second
+  double d = stt * svv - svt * svt;
+  if (d > 0.0 && stt > 0.0) {
+    det = d;
+    drag = (stt * svy - svt * sty) / det;
+    power = (sty - drag * svt) / stt;
+  }
+}
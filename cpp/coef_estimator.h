@@ -0,0 +1,58 @@
+#ifndef COEF_ESTIMATOR_H
+#define COEF_ESTIMATOR_H
+
+// power and drag of v_n+1 = drag * v_n + power * throttle, refit on every
+// tick by recursive least squares. the sums of the 2x2 normal equations
+// are updated in place and solved each time, which is the same fit as
+// batch least squares over all the ticks so far (exact after two clean
+// ticks) at a constant cost per tick.
+//
+// the caller leaves out the ticks it knows break the model (piece changes,
+// lane switches, turbo changes); add() itself rejects a tick whose
+// residual is far outside what the fit has seen, like the ticks of a crash.
+// a fit restored from another race is on trial: if this race contradicts
+// it RESTART ticks in a row before confirming it with RESTART accepted
+// ticks, it is dropped and the fit starts over. a confirmed fit is never
+// dropped, so a collision or a long turbo cannot undo it.
+struct CoefEstimator {
+  static const int RESTART = 8;
+
+  // what the fit has learned, to carry it over to another race
+  struct state {
+    double svv, svt, stt, svy, sty;
+    double resvar;
+    int accepted;
+  };
+
+  double power, drag;
+  int accepted, rejected;
+
+  // forget: weight of the past per tick, 1 to keep everything.
+  // a residual beyond gate times the residual deviation, or floor, is an
+  // outlier once the fit has more than two ticks.
+  explicit CoefEstimator(double forget = 1.0, double gate = 5.0, double floor = 1e-3);
+
+  // one tick: speed before, speed after and the throttle times any turbo
+  // factor in between. false if it was rejected
+  bool add(double speed, double next, double throttle);
+  // a tick the caller knows to be unusable, for the counts
+  void skip() { rejected++; }
+
+  bool ready() const { return accepted >= 2 && det > 0.0; }
+  state save() const;
+  void restore(const state& s);
+  double predict(double speed, double throttle) const { return drag * speed + power * throttle; }
+
+private:
+  double forget, gate, floor;
+  // sums of v*v, v*t, t*t, v*v', t*v' over the accepted ticks
+  double svv, svt, stt, svy, sty;
+  double det;
+  double resvar; // running mean of the squared residuals of accepted ticks
+  int streak; // rejections since the last accepted tick
+  int trial; // accepted ticks a restored fit still needs to be confirmed
+
+  void solve();
+};
+
+#endif
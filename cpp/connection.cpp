@@ -1,47 +1,70 @@
 #include "connection.h"
 
 hwo_connection::hwo_connection(const std::string& host, const std::string& port, const std::string& logname)
-  : socket(io_service)
+  : socket(io_service), line_len(0), rawlog_buf(1 << 16)
 {
   tcp::resolver resolver(io_service);
   tcp::resolver::query query(host, port);
   boost::asio::connect(socket, resolver.resolve(query));
   response_buf.prepare(8192);
+  // before open, or the filebuf keeps its own
+  rawlog.rdbuf()->pubsetbuf(rawlog_buf.data(), rawlog_buf.size());
   rawlog.open("rawlog" + logname + ".txt");
 }
 
 hwo_connection::~hwo_connection()
 {
+  rawlog.flush();
   socket.close();
 }
 
 jsoncons::json hwo_connection::receive_response(boost::system::error_code& error)
 {
-  auto len = boost::asio::read_until(socket, response_buf, "\n", error);
+  raw_line reply = receive_line(error);
   if (error)
   {
     return jsoncons::json();
   }
-  auto buf = response_buf.data();
-  std::string reply(boost::asio::buffers_begin(buf), boost::asio::buffers_begin(buf) + len);
-  rawlog << "<< " << reply; // newline included
-  response_buf.consume(len);
-  return jsoncons::json::parse_string(reply);
+  return jsoncons::json::parse(reply.data, reply.size);
 }
 
-void hwo_connection::send_requests(const std::vector<jsoncons::json>& msgs)
+hwo_connection::raw_line hwo_connection::receive_line(boost::system::error_code& error)
 {
-  jsoncons::output_format format;
-  format.escape_all_non_ascii(true);
-  boost::asio::streambuf request_buf;
-  std::ostream s(&request_buf);
-  for (const auto& m : msgs) {
-    m.to_stream(s, format);
-    s << std::endl;
+  response_buf.consume(line_len);
+  line_len = 0;
+  auto len = boost::asio::read_until(socket, response_buf, "\n", error);
+  if (error)
+  {
+    return raw_line { "", 0 };
+  }
+  // a basic_streambuf keeps its input in one piece
+  const char* data = boost::asio::buffer_cast<const char*>(*response_buf.data().begin());
+  line_len = len;
+  rawlog << "<< ";
+  rawlog.write(data, len);
+  return raw_line { data, len };
+}
 
+void hwo_connection::send_requests(const hwo_protocol::outbox& msgs)
+{
+  const std::string& text = msgs.text();
+  socket.send(boost::asio::buffer(text));
+  // the reply is out, so the write waits on nothing but the next message
+  for (const auto& m : msgs) {
     rawlog << ">> ";
-    m.to_stream(rawlog, format);
-    rawlog << std::endl;
+    rawlog.write(text.data() + m.begin, m.end - m.begin);
+    rawlog << '\n';
   }
-  socket.send(request_buf.data());
+}
+
+void hwo_connection::flush_rawlog()
+{
+  rawlog.flush();
+}
+
+size_t hwo_connection::pending_bytes()
+{
+  boost::system::error_code error;
+  size_t unread = socket.available(error);
+  return response_buf.size() - line_len + (error ? 0 : unread);
 }
@@ -6,6 +6,8 @@
 #include <boost/asio.hpp>
 #include <jsoncons/json.hpp>
 #include <fstream>
+#include <vector>
+#include "protocol.h"
 
 using boost::asio::ip::tcp;
 
@@ -15,12 +17,29 @@ public:
   hwo_connection(const std::string& host, const std::string& port, const std::string& logname);
   ~hwo_connection();
   jsoncons::json receive_response(boost::system::error_code& error);
-  void send_requests(const std::vector<jsoncons::json>& msgs);
+  // a message in the receive buffer, newline included
+  struct raw_line {
+    const char* data;
+    size_t size;
+  };
+  // the next message in place; valid until the next receive
+  raw_line receive_line(boost::system::error_code& error);
+  // in one write
+  void send_requests(const hwo_protocol::outbox& msgs);
+  // received but not yet returned by receive_line
+  size_t pending_bytes();
+  // the rawlog so far to the file, between races rather than every tick
+  void flush_rawlog();
 
 private:
   boost::asio::io_service io_service;
   tcp::socket socket;
   boost::asio::streambuf response_buf;
+  size_t line_len; // consumed from response_buf on the next receive
+  // every line both ways, for ./replay. written here rather than through
+  // the logger, whose log level and full ring would lose lines. written
+  // out when the buffer fills, at gameEnd and on close
+  std::vector<char> rawlog_buf;
   std::ofstream rawlog;
 };
 
@@ -1,28 +1,23 @@
 #include "game_logic.h"
 #include "protocol.h"
+#include "logger.h"
+#include "track_cache.h"
+#include <chrono>
 #include <cmath>
 
 using namespace hwo_protocol;
 
-game_logic::game_logic()
-  : action_map
-    {
-      { "join", &game_logic::on_join },
-      { "gameStart", &game_logic::on_game_start },
-      { "gameInit", &game_logic::on_game_init },
-      { "carPositions", &game_logic::on_car_positions },
-      { "crash", &game_logic::on_crash },
-      { "gameEnd", &game_logic::on_game_end },
-      { "error", &game_logic::on_error },
-      { "yourCar", &game_logic::on_your_car },
-      { "turboAvailable", &game_logic::on_turbo_avail },
-      { "turboStart", &game_logic::on_turbo_start },
-      { "turboEnd", &game_logic::on_turbo_end }
-    },
+game_logic::game_logic(const player_config& config)
+  : config(config),
     track { {}, { 0.0 }, 0 },
+    trackindex(),
     mycar(),
     current_tick { -1 },
     mycolor(""),
+    dom_positions(),
+    telemetry(nullptr),
+    track_id(0),
+    replies(),
     lane_gonna_change(false),
     lane_changing(true),
 
@@ -30,93 +25,182 @@ game_logic::game_logic()
 {
 }
 
-game_logic::msg_vector game_logic::react(const jsoncons::json& msg)
+const game_logic::msg_vector& game_logic::react(const jsoncons::json& msg)
 {
-  const auto& msg_type = msg["msgType"].as<std::string>();
-  const auto& data = msg["data"];
-  int tick = msg.get("gameTick", -1).as<int>();
+  return react(parse_msg_type(msg), msg);
+}
+
+const game_logic::msg_vector& game_logic::react(msg_type type, const jsoncons::json& msg)
+{
+  return dispatch(type, msg);
+}
+
+const game_logic::msg_vector& game_logic::react(const jsoncons::arena_json& msg)
+{
+  return react(parse_msg_type(msg), msg);
+}
+
+const game_logic::msg_vector& game_logic::react(msg_type type, const jsoncons::arena_json& msg)
+{
+  return dispatch(type, msg);
+}
 
-  std::cout << "msg tick " << tick << std::endl;
+template <class Json>
+const game_logic::msg_vector& game_logic::dispatch(msg_type type, const Json& msg)
+{
+  replies.clear();
+  // the handlers read through views: nothing is copied and member names
+  // are looked up without making strings
+  auto view = jsoncons::view_of(msg);
+  auto data = view["data"];
+  int tick = view.get("gameTick", -1);
+
+  LOG_DEBUG(logging::OUT) << "msg tick " << tick;
   if (tick != -1)
     current_tick = tick;
 
-  auto action_it = action_map.find(msg_type);
-  if (action_it != action_map.end())
+  switch (type)
   {
-    msg_vector act = (action_it->second)(this, data);
-    if (tick != -1 && act.size() == 0 && msg_type != "turboAvailable" && msg_type != "turboStart" && msg_type != "turboEnd") {
-      std::cout << "BUG: got tick but did no actions" << std::endl;
-      act = { make_ping() };
-    }
-    return act;
+  case MSG_JOIN: on_join(data); break;
+  case MSG_GAME_START: on_game_start(data); break;
+  case MSG_GAME_INIT: on_game_init(data); break;
+  case MSG_CAR_POSITIONS: on_car_positions(data); break;
+  case MSG_CRASH: on_crash(data); break;
+  case MSG_GAME_END: on_game_end(data); break;
+  case MSG_ERROR: on_error(data); break;
+  case MSG_YOUR_CAR: on_your_car(data); break;
+  case MSG_TURBO_AVAILABLE: on_turbo_avail(data); break;
+  case MSG_TURBO_START: on_turbo_start(data); break;
+  case MSG_TURBO_END: on_turbo_end(data); break;
+  default:
+    LOG_WARN(logging::OUT) << "Unknown message type: " << view["msgType"].template as<std::string>();
+    if (tick != -1)
+      replies.ping();
+    return replies;
   }
-  else
-  {
-    std::cout << "Unknown message type: " << msg_type << std::endl;
-    if (tick == -1)
-      return {};
-    return { make_ping() };
+
+  if (tick != -1 && replies.empty() && needs_reply(type)) {
+    LOG_WARN(logging::OUT) << "BUG: got tick but did no actions";
+    replies.ping();
   }
+  return replies;
 }
 
-game_logic::msg_vector game_logic::on_join(const jsoncons::json& data)
+const game_logic::msg_vector& game_logic::react(const CarPositions& positions)
 {
-  std::cout << "Joined" << std::endl;
-  return { };
+  replies.clear();
+  int tick = positions.tick;
+
+  LOG_DEBUG(logging::OUT) << "msg tick " << tick;
+  if (tick != -1)
+    current_tick = tick;
+
+  on_positions(positions);
+  if (tick != -1 && replies.empty()) {
+    LOG_WARN(logging::OUT) << "BUG: got tick but did no actions";
+    replies.ping();
+  }
+  return replies;
 }
 
-game_logic::msg_vector game_logic::on_game_init(const jsoncons::json& data)
+const game_logic::msg_vector& game_logic::react(const GameInit& init)
 {
-  std::cout << "Game init" << std::endl;
+  replies.clear();
+  on_game_init(init);
+  return replies;
+}
 
-  track = data["race"]["track"].as<Track>();
-  mycar = Player(&track);
-  for (auto& piece: track.track) {
-    std::cout << piece << std::endl;
-  }
-  std::cout << track.track.size() << " pieces in total, lane count " << track.nlanes << std::endl;
-  std::cout << "lane dists";
-  for (auto& x: track.lanedist)
-    std::cout << " " << x;
-  std::cout << std::endl;
+template <class Json>
+void game_logic::on_join(const Json& data)
+{
+  LOG_INFO(logging::OUT) << "Joined";
+}
 
+template <class Json>
+void game_logic::on_game_init(const Json& data)
+{
+  GameInit init;
+  init.track = data["race"]["track"].template as<Track>();
   auto cars = data["race"]["cars"];
   for (size_t i = 0; i < cars.size(); i++) {
-    std::cout << "car "
-      << cars[i]["id"]["name"] << " "
-      << cars[i]["id"]["color"]
-      << std::endl;
+    const std::string name = cars[i]["id"]["name"].template as<std::string>();
+    const std::string color = cars[i]["id"]["color"].template as<std::string>();
+    CarId id;
+    copy_name(id.name, name.data(), name.size());
+    copy_name(id.color, color.data(), color.size());
+    init.cars.push_back(id);
+  }
+  on_game_init(init);
+}
+
+void game_logic::on_game_init(const GameInit& init)
+{
+  LOG_INFO(logging::OUT) << "Game init";
+
+  track = init.track;
+  trackindex = TrackIndex(track);
+  mycar = Player(&track, &trackindex, config);
+  if (!cache_dir.empty()) {
+    track_id = track_hash(track);
+    auto t0 = std::chrono::steady_clock::now();
+    bool loaded = load_track_model(track_cache_path(cache_dir, track_id), track_id, mycar);
+    double us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - t0).count();
+    LOG_INFO(logging::OUT) << "track cache: " << (loaded ? "loaded a plan" : "nothing") << " in " << us << " us"
+      << ", p=" << mycar.power << " d=" << mycar.drag;
+  }
+  for (auto& piece: track.track) {
+    LOG_DEBUG(logging::OUT) << piece;
+  }
+  LOG_INFO(logging::OUT) << track.track.size() << " pieces in total, lane count " << track.nlanes;
+  LOG_INFO(logging::OUT) << "lane dists"
+    << " " << track.lanedist[0] << " " << track.lanedist[1]
+    << " " << track.lanedist[2] << " " << track.lanedist[3];
+
+  for (auto& car: init.cars) {
+    LOG_INFO(logging::OUT) << "car " << car.name << " " << car.color;
   }
-  return { };
 }
 
-game_logic::msg_vector game_logic::on_game_start(const jsoncons::json& data)
+template <class Json>
+void game_logic::on_game_start(const Json& data)
 {
-  std::cout << "Race started" << std::endl;
+  LOG_INFO(logging::OUT) << "Race started";
 
   // (a carpositions with no ticks might come before the start so that starts
   // includes the first tick)
 
   // just go full speed here to estimate the track coefs
-  if (current_tick < 1)
-    return { make_throttle(1.0, 0) };
+  if (current_tick < 1) {
+    replies.throttle(1.0, 0);
+    mycar.applied_throttle = 1.0;
+  }
   // not started yet? no commands
-  return { };
 }
 
-game_logic::msg_vector game_logic::on_car_positions(const jsoncons::json& data)
+template <class Json>
+void game_logic::on_car_positions(const Json& data)
+{
+  dom_positions.tick = current_tick;
+  dom_positions.ncars = std::min((int)data.size(), CarPositions::MAX_CARS);
+  for (int i = 0; i < dom_positions.ncars; i++)
+    dom_positions.cars[i] = data[i].template as<CarPosition>();
+  on_positions(dom_positions);
+}
+
+void game_logic::on_positions(const CarPositions& positions)
 {
-  std::cout << "Position tick";
-
-  auto positions = data.as<std::vector<CarPosition>>();
-  CarPosition now;
-  for (CarPosition& p: positions) {
-    std::cout << " " << p.name << ":" << p.color
-      << "=(" << p.pieceIndex << "," << p.inPieceDistance << ")";
-    if (p.color == mycolor)
-      now = p;
+  CarPosition now = CarPosition();
+  {
+    logging::line_at<LOG_LEVEL_DEBUG> log(logging::OUT);
+    log << "Position tick";
+    for (int i = 0; i < positions.ncars; i++) {
+      const CarPosition& p = positions.cars[i];
+      log << " " << p.name << ":" << p.color
+        << "=(" << p.pieceIndex << "," << p.inPieceDistance << ")";
+      if (mycolor == p.color)
+        now = p;
+    }
   }
-  std::cout << std::endl;
 
   double lanedist = track.lanedist[now.startLane];
   double angspeed = mycar.prev.angle - now.angle;
@@ -133,7 +217,7 @@ game_logic::msg_vector game_logic::on_car_positions(const jsoncons::json& data)
 
   double throttle = compute_throttle(now);
 
-  std::cout
+  LOG_DEBUG(logging::OUT)
     << "ticks " << mycar.nticks
     << ", current index " << now.pieceIndex
     << ", current travel " << track.track[now.pieceIndex].travel(lanedist)
@@ -142,38 +226,58 @@ game_logic::msg_vector game_logic::on_car_positions(const jsoncons::json& data)
     << ", this speed: " << mycar.curspeed
     << ", angle: " << now.angle
     << ", angular speed: " << angspeed
-    << ", throttle: " << throttle
-    << std::endl;
-
-  std::cerr << mycar.nticks
-    << " " << mycar.tottravel
-    << " " << mycar.curspeed
-    << " " << now.pieceIndex
-    << " " << now.angle
-    << " " << angspeed
-    << " " << throttle
-    << std::endl;
-
-  jsoncons::json msg = make_throttle(throttle, mycar.nticks);
-  if (mycar.nticks >= Player::COEF_MEAS_TICKS && !lane_gonna_change) {
-    int lane_change = need_lane_change(now);
-    if (lane_change) {
-      msg = make_lane_change(lane_change == -1 ? "Left" : "Right");
-      lane_gonna_change = true;
+    << ", throttle: " << throttle;
+
+  if (telemetry) {
+    for (int i = 0; i < positions.ncars; i++) {
+      const CarPosition& p = positions.cars[i];
+      telemetry_row row {
+        current_tick, i, p.pieceIndex, p.startLane, p.endLane, p.lap,
+        p.inPieceDistance, p.angle,
+        -1, NAN, NAN, NAN, NAN, NAN
+      };
+      if (mycolor == p.color) {
+        row.nticks = mycar.nticks;
+        row.tottravel = mycar.tottravel;
+        row.speed = mycar.curspeed;
+        row.angspeed = angspeed;
+        row.throttle = throttle;
+        row.turbofactor = mycar.turbofactor;
+      }
+      telemetry->append(row);
     }
   }
-  if (mycar.nticks >= Player::COEF_MEAS_TICKS && now.pieceIndex == turbostartpos) {
-    msg = make_turbo("Pow pow pow pow pow i can haz the speeds");
+
+  // one message per tick: turbo over a lane change over the throttle.
+  // none is sent for positions before the start, so nothing is decided on
+  // them either
+  int lane_change = 0;
+  bool turbo = false;
+  bool decide = current_tick != -1 && !mycar.warming_up();
+  if (decide && !lane_gonna_change) {
+    lane_change = need_lane_change(now);
+    if (lane_change)
+      lane_gonna_change = true;
+  }
+  if (decide && now.pieceIndex == turbostartpos) {
+    turbo = true;
     turbostartpos = -1;
-    std::cout << "PEW PEW TURBO BUTTON" << std::endl;
+    LOG_INFO(logging::OUT) << "PEW PEW TURBO BUTTON";
   }
+  int nticks = mycar.nticks;
 
   mycar.endtick(now);
 
-  // first positions may come before start
   if (current_tick == -1)
-    return {};
-  return { msg };
+    return;
+  if (turbo)
+    replies.turbo("Pow pow pow pow pow i can haz the speeds");
+  else if (lane_change)
+    replies.lane_change(lane_change);
+  else {
+    replies.throttle(throttle, nticks);
+    mycar.applied_throttle = throttle;
+  }
 }
 
 int game_logic::need_lane_change(const CarPosition& now) const {
@@ -181,32 +285,29 @@ int game_logic::need_lane_change(const CarPosition& now) const {
   // does not take into account any lengths or such, so may decide wrong
   // e.g. if there is a longer bend just after the next one
 
-  size_t next_switch = 0, then_switch = 0;
+  // the switch search is limited to the pieces [1, n-3] ahead
+  int n = trackindex.npieces;
+  int next_switch = 0, then_switch = 0;
   double left_travel = 0.0, right_travel = 0.0;
   int nbends = 0;
 
-  for (size_t i = 1; i < track.track.size() - 2; i++) {
-    size_t n = (now.pieceIndex + i) % track.track.size();
-    const Piece& p = track.track[n];
-
-    if (p.switch_ && next_switch == 0) {
-      next_switch = i;
-    } else if (p.switch_ && next_switch != 0) {
-      for (size_t j = next_switch; j < i; j++) { // or: j <= i?
-        size_t m = (now.pieceIndex + j) % track.track.size();
-        const Piece& q = track.track[m];
-        left_travel  += q.travel(track.lanedist[std::max(now.endLane-1, 0)]);
-        right_travel += q.travel(track.lanedist[std::min(now.endLane+1, track.nlanes-1)]);
-        if (q.length == 0.0)
-          nbends++;
-      }
-      then_switch = i;
-      break;
+  int cand = 1 + trackindex.switch_offset[(now.pieceIndex + 1) % n];
+  if (cand < n - 2) {
+    next_switch = cand;
+    cand = next_switch + 1 + trackindex.switch_offset[(now.pieceIndex + next_switch + 1) % n];
+    if (cand < n - 2) {
+      then_switch = cand;
+      int from = (now.pieceIndex + next_switch) % n;
+      int to = (now.pieceIndex + then_switch) % n;
+      left_travel  = trackindex.span(std::max(now.endLane-1, 0), from, to);
+      right_travel = trackindex.span(std::min(now.endLane+1, track.nlanes-1), from, to);
+      nbends = trackindex.bends_between(from, to);
     }
   }
-  std::cout << "UGUU " << next_switch << " " << then_switch << " " << left_travel << " " << right_travel << std::endl;
+  LOG_DEBUG(logging::OUT) << "UGUU " << next_switch << " " << then_switch << " " << left_travel << " " << right_travel;
 
-  bool target_right = right_travel < left_travel;
+  // prefix sums round differently from a piecewise sum; keep exact ties left
+  bool target_right = right_travel < left_travel - 1e-9;
 
   if (next_switch != 0 && nbends != 0) {
     // can switch because there is a switch piece
@@ -224,10 +325,10 @@ int game_logic::need_lane_change(const CarPosition& now) const {
     }
 
     if (!target_right && track.lanedist[now.endLane] > track.lanedist[min_lane])
-    { std::cout << "LANELEFT:min="<<min_lane<<",max="<<max_lane<<",cur="<<now.endLane<<" nextsw="<<now.pieceIndex+next_switch<<std::endl;
+    { LOG_DEBUG(logging::OUT) << "LANELEFT:min="<<min_lane<<",max="<<max_lane<<",cur="<<now.endLane<<" nextsw="<<now.pieceIndex+next_switch;
       return -1; }
     else if (target_right && track.lanedist[now.endLane] < track.lanedist[max_lane])
-    { std::cout << "LANERIGHT:min="<<min_lane<<",max="<<max_lane<<",cur="<<now.endLane<<" nextsw="<<now.pieceIndex+next_switch<<std::endl;
+    { LOG_DEBUG(logging::OUT) << "LANERIGHT:min="<<min_lane<<",max="<<max_lane<<",cur="<<now.endLane<<" nextsw="<<now.pieceIndex+next_switch;
       return 1; }
   }
   return 0;
@@ -235,7 +336,7 @@ int game_logic::need_lane_change(const CarPosition& now) const {
 
 double game_logic::compute_throttle(const CarPosition& now) const
 {
-  if (mycar.nticks < Player::COEF_MEAS_TICKS)
+  if (mycar.warming_up())
     return 1.0; // for coef estimation
   else
     return mycar.compute_throttle(now);
@@ -246,62 +347,71 @@ double game_logic::compute_throttle(const CarPosition& now) const
 #endif
 }
 
-game_logic::msg_vector game_logic::on_crash(const jsoncons::json& data)
+template <class Json>
+void game_logic::on_crash(const Json& data)
 {
-  std::cout << "Someone crashed" << std::endl;
-  return { make_ping() };
+  std::string color = data["color"].template as<std::string>();
+  LOG_INFO(logging::OUT) << color << " crashed";
+  if (color == mycolor)
+    mycar.on_crash();
+  replies.ping();
 }
 
-game_logic::msg_vector game_logic::on_game_end(const jsoncons::json& data)
+template <class Json>
+void game_logic::on_game_end(const Json& data)
 {
-  std::cout << "Race ended" << std::endl;
-  return { make_ping() };
+  LOG_INFO(logging::OUT) << "Race ended";
+  if (!cache_dir.empty() && save_track_model(track_cache_path(cache_dir, track_id), track_id, mycar)) {
+    LOG_INFO(logging::OUT) << "track cache: saved";
+  }
+  replies.ping();
 }
 
-game_logic::msg_vector game_logic::on_error(const jsoncons::json& data)
+template <class Json>
+void game_logic::on_error(const Json& data)
 {
-  std::cout << "Error: " << data.to_string() << std::endl;
-  return { make_ping() };
+  LOG_ERROR(logging::OUT) << "Error: " << data.to_string();
+  replies.ping();
 }
 
-game_logic::msg_vector game_logic::on_your_car(const jsoncons::json& data)
+template <class Json>
+void game_logic::on_your_car(const Json& data)
 {
-  mycolor = data["color"].as<std::string>();
-  return { };
+  mycolor = data["color"].template as<std::string>();
 }
 
 // these contain the gametick field but do not need a response?
 // a carpositions with same tick follows
-game_logic::msg_vector game_logic::on_turbo_avail(const jsoncons::json& data)
+template <class Json>
+void game_logic::on_turbo_avail(const Json& data)
 {
-  turbo_ticks = data["turboDurationTicks"].as<int>();
-  turbo_factor = data["turboFactor"].as<double>();
+  turbo_ticks = data["turboDurationTicks"].template as<int>();
+  turbo_factor = data["turboFactor"].template as<double>();
   turbostartpos = mycar.best_turbo_start();
-  std::cout << "CAN HAZ TURBO?? dur="
+  LOG_INFO(logging::OUT) << "CAN HAZ TURBO?? dur="
     << turbo_ticks << " fact=" << turbo_factor
-    << " starting at " << turbostartpos << std::endl;
-  return { };
+    << " starting at " << turbostartpos;
 }
 
-game_logic::msg_vector game_logic::on_turbo_start(const jsoncons::json& data)
+template <class Json>
+void game_logic::on_turbo_start(const Json& data)
 {
-  std::string color = data["color"].as<std::string>();
+  std::string color = data["color"].template as<std::string>();
   if (color == mycolor) {
-    std::cout << "PEW PEW" << std::endl;
+    LOG_INFO(logging::OUT) << "PEW PEW";
     mycar.set_turbo(turbo_factor);
     turbo_ticks = 0;
     turbo_factor = 0.0;
     turbostartpos = -1;
   }
-  return { };
 }
 
-game_logic::msg_vector game_logic::on_turbo_end(const jsoncons::json& data)
+template <class Json>
+void game_logic::on_turbo_end(const Json& data)
 {
-  std::string color = data["color"].as<std::string>();
+  std::string color = data["color"].template as<std::string>();
   if (color == mycolor) {
-    std::cout << "NO MORE PEW PEW" << std::endl;
+    LOG_INFO(logging::OUT) << "NO MORE PEW PEW";
     mycar.reset_turbo();
   }
-  return { };
 }
@@ -3,44 +3,69 @@
 
 #include "player.h"
 #include "game_objs.h"
+#include "track_index.h"
+#include "telemetry.h"
+#include "protocol.h"
 #include <string>
 #include <vector>
-#include <map>
-#include <functional>
 #include <iostream>
 #include <jsoncons/json.hpp>
 
 class game_logic
 {
 public:
-  typedef std::vector<jsoncons::json> msg_vector;
+  typedef hwo_protocol::outbox msg_vector;
 
-  game_logic();
-  msg_vector react(const jsoncons::json& msg);
+  explicit game_logic(const player_config& config = player_config());
+  // the replies; valid until the next react
+  const msg_vector& react(const jsoncons::json& msg);
+  // for a msgType already known from decoding
+  const msg_vector& react(hwo_protocol::msg_type type, const jsoncons::json& msg);
+  // the same for a message parsed into a json_arena
+  const msg_vector& react(const jsoncons::arena_json& msg);
+  const msg_vector& react(hwo_protocol::msg_type type, const jsoncons::arena_json& msg);
+  // the same for a carPositions decoded without the json tree
+  const msg_vector& react(const CarPositions& positions);
+  // and for a gameInit
+  const msg_vector& react(const GameInit& init);
+  // per tick rows for every car; null (the default) records nothing
+  void set_telemetry(telemetry_recorder* recorder) { telemetry = recorder; }
+  // where to keep what was learned of each track between races (see
+  // track_cache.h); empty (the default) starts every race from nothing
+  void set_track_cache(const std::string& dir) { cache_dir = dir; }
 
 private:
-  typedef std::function<msg_vector(game_logic*, const jsoncons::json&)> action_fun;
-  const std::map<std::string, action_fun> action_map;
-
-  msg_vector on_join(const jsoncons::json& data);
-  msg_vector on_game_start(const jsoncons::json& data);
-  msg_vector on_game_init(const jsoncons::json& data);
-  msg_vector on_car_positions(const jsoncons::json& data);
-  msg_vector on_crash(const jsoncons::json& data);
-  msg_vector on_game_end(const jsoncons::json& data);
-  msg_vector on_error(const jsoncons::json& data);
-  msg_vector on_your_car(const jsoncons::json& data);
-  msg_vector on_turbo_avail(const jsoncons::json& data);
-  msg_vector on_turbo_start(const jsoncons::json& data);
-  msg_vector on_turbo_end(const jsoncons::json& data);
+  // the handlers read either kind of json tree
+  template <class Json>
+  const msg_vector& dispatch(hwo_protocol::msg_type type, const Json& msg);
+  template <class Json> void on_join(const Json& data);
+  template <class Json> void on_game_start(const Json& data);
+  template <class Json> void on_game_init(const Json& data);
+  void on_game_init(const GameInit& init);
+  template <class Json> void on_car_positions(const Json& data);
+  void on_positions(const CarPositions& positions);
+  template <class Json> void on_crash(const Json& data);
+  template <class Json> void on_game_end(const Json& data);
+  template <class Json> void on_error(const Json& data);
+  template <class Json> void on_your_car(const Json& data);
+  template <class Json> void on_turbo_avail(const Json& data);
+  template <class Json> void on_turbo_start(const Json& data);
+  template <class Json> void on_turbo_end(const Json& data);
 
   double compute_throttle(const CarPosition& now) const;
   int need_lane_change(const CarPosition& now) const;
 
+  player_config config; // for the Player of each race
   Track track;
+  TrackIndex trackindex;
   Player mycar;
   int current_tick;
   std::string mycolor;
+  CarPositions dom_positions; // on_car_positions decodes here
+  telemetry_recorder* telemetry;
+  std::string cache_dir;
+  uint64_t track_id; // track_hash of track
+  msg_vector replies; // the handlers write here
 
   bool lane_gonna_change, lane_changing;
 
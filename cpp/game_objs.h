@@ -3,8 +3,12 @@
 
 #include <iostream>
 #include <jsoncons/json.hpp>
+#include <jsoncons/key_path.hpp>
+#include <jsoncons/json_view.hpp>
+#include <jsoncons/struct_decoder.hpp>
 #include <vector>
 #include <array>
+#include <algorithm>
 
 struct Piece {
   double length; // straight
@@ -35,30 +39,158 @@ struct Track {
   std::vector<Piece> track;
   std::array<double, 4> lanedist; // distance from center
   int nlanes;
+  unsigned lanemask; // which of lanedist are set, a bit each
 };
 
+// one of the lanes of a track as the server lists them
+struct TrackLane {
+  int index;
+  double distanceFromCenter;
+};
+
+// plain data so that a whole carPositions fits in a reusable buffer; longer
+// names get truncated
 struct CarPosition {
-  std::string name, color;
+  char name[32], color[16];
   double angle;
   int pieceIndex;
   double inPieceDistance;
   int startLane, endLane;
+  int lap;
+};
+
+// one carPositions message
+struct CarPositions {
+  static const int MAX_CARS = 8;
+  int tick; // -1 for the one before the start
+  int ncars;
+  CarPosition cars[MAX_CARS];
+};
+
+// the cars of a gameInit
+struct CarId {
+  char name[32], color[16];
 };
 
+// the parts of a gameInit the bot uses
+struct GameInit {
+  Track track;
+  std::vector<CarId> cars;
+};
+
+// strncpy that always terminates
+template <size_t N>
+void copy_name(char (&dst)[N], const char* src, size_t len) {
+  len = std::min(len, N - 1);
+  std::copy(src, src + len, dst);
+  dst[len] = '\0';
+}
+
 namespace jsoncons {
 
+// where the structs are in the messages, for struct_decoder
+
+template <>
+class json_fields<char, Piece> {
+  public:
+    static void describe(basic_struct_layout<char, Piece>& layout) {
+      layout.field("length", &Piece::length);
+      layout.field("radius", &Piece::radius);
+      layout.field("angle", &Piece::angle);
+      layout.field("switch", &Piece::switch_);
+    }
+};
+
+template <>
+class json_fields<char, TrackLane> {
+  public:
+    static void describe(basic_struct_layout<char, TrackLane>& layout) {
+      layout.field("index", &TrackLane::index, required_field);
+      layout.field("distanceFromCenter", &TrackLane::distanceFromCenter, required_field);
+    }
+};
+
+template <>
+class json_fields<char, Track> {
+  public:
+    static void describe(basic_struct_layout<char, Track>& layout) {
+      layout.array("pieces", &Track::track, required_field);
+      layout.each("lanes", &add_lane, required_field);
+    }
+
+  private:
+    // should be 1..4 lanes but only those that fit are kept, and each
+    // index counted once, so that nlanes never runs past lanedist
+    static void add_lane(Track& track, const TrackLane& lane) {
+      if (lane.index < 0 || lane.index >= (int)track.lanedist.size())
+        return;
+      track.lanedist[lane.index] = lane.distanceFromCenter;
+      unsigned bit = 1u << lane.index;
+      if (!(track.lanemask & bit)) {
+        track.lanemask |= bit;
+        track.nlanes++;
+      }
+    }
+};
+
+template <>
+class json_fields<char, CarId> {
+  public:
+    static void describe(basic_struct_layout<char, CarId>& layout) {
+      layout.field({ "id", "name" }, &CarId::name, required_field);
+      layout.field({ "id", "color" }, &CarId::color, required_field);
+    }
+};
+
+template <>
+class json_fields<char, GameInit> {
+  public:
+    static void describe(basic_struct_layout<char, GameInit>& layout) {
+      layout.match("msgType", "gameInit");
+      layout.object({ "data", "race", "track" }, &GameInit::track, required_field);
+      layout.array({ "data", "race", "cars" }, &GameInit::cars);
+    }
+};
+
+template <>
+class json_fields<char, CarPosition> {
+  public:
+    static void describe(basic_struct_layout<char, CarPosition>& layout) {
+      layout.field({ "id", "name" }, &CarPosition::name, required_field);
+      layout.field({ "id", "color" }, &CarPosition::color, required_field);
+      layout.field("angle", &CarPosition::angle, required_field);
+      layout.field({ "piecePosition", "pieceIndex" }, &CarPosition::pieceIndex, required_field);
+      layout.field({ "piecePosition", "inPieceDistance" }, &CarPosition::inPieceDistance, required_field);
+      layout.field({ "piecePosition", "lane", "startLaneIndex" }, &CarPosition::startLane, required_field);
+      layout.field({ "piecePosition", "lane", "endLaneIndex" }, &CarPosition::endLane, required_field);
+      layout.field({ "piecePosition", "lap" }, &CarPosition::lap, 0);
+    }
+};
+
+template <>
+class json_fields<char, CarPositions> {
+  public:
+    static void describe(basic_struct_layout<char, CarPositions>& layout) {
+      layout.match("msgType", "carPositions");
+      layout.field("gameTick", &CarPositions::tick, -1);
+      // more than MAX_CARS cars do not decode
+      layout.array("data", &CarPositions::cars, &CarPositions::ncars, required_field);
+    }
+};
+
 template <class Storage>
 class value_adapter<char, Storage, Piece> {
   public:
-    Track is(const basic_json<char, Storage>& val) const {
+    bool is(const basic_json<char, Storage>& val) const {
       return true;
     }
     Piece as(const basic_json<char, Storage>& val) const {
+      basic_json_view<char, Storage> piece(val);
       return Piece{
-        val.get("length", 0.0)  .template as<double>(),
-        val.get("radius", 0.0)  .template as<double>(),
-        val.get("angle", 0.0)   .template as<double>(),
-        val.get("switch", false).template as<bool>()
+        piece.get("length", 0.0),
+        piece.get("radius", 0.0),
+        piece.get("angle", 0.0),
+        piece.get("switch", false)
       };
     }
 };
@@ -66,22 +198,34 @@ class value_adapter<char, Storage, Piece> {
 template <class Storage>
 class value_adapter<char, Storage, Track> {
   public:
-    Track is(const basic_json<char, Storage>& val) const {
+    bool is(const basic_json<char, Storage>& val) const {
       return true;
     }
     Track as(const basic_json<char, Storage>& val) const {
-      auto pieces = val["pieces"].template as<std::vector<Piece>>();
-      auto lanes  = val["lanes"] .template as<json::array>();
+      basic_json_view<char, Storage> track(val);
+      auto pieces = track["pieces"].template as<std::vector<Piece>>();
+      auto lanes = track["lanes"];
 
       std::array<double, 4> dists = {0.0};
-      // should be 1..4 lanes but min() to be safe
-      for (size_t i = 0; i < std::min(lanes.size(), 4UL); i++)
-        dists[lanes[i]["index"].template as<int>()] = lanes[i]["distanceFromCenter"].template as<double>();
+      int nlanes = 0;
+      unsigned mask = 0;
+      // should be 1..4 lanes; like add_lane, only those that fit count, once
+      for (size_t i = 0; i < lanes.size(); i++) {
+        int index = lanes[i]["index"].template as<int>();
+        if (index < 0 || index >= (int)dists.size())
+          continue;
+        dists[index] = lanes[i]["distanceFromCenter"].template as<double>();
+        if (!(mask & (1u << index))) {
+          mask |= 1u << index;
+          nlanes++;
+        }
+      }
 
       return Track{
         pieces,
         dists,
-        (int)lanes.size()
+        nlanes,
+        mask
       };
     }
 };
@@ -90,17 +234,35 @@ template <class Storage>
 class value_adapter<char, Storage, CarPosition> {
   public:
     CarPosition as(const basic_json<char, Storage>& val) const {
-      auto pos = val["piecePosition"];
-      return CarPosition{
-        val["id"]["name"]            .template as<std::string>(),
-        val["id"]["color"]           .template as<std::string>(),
-        val["angle"]                 .template as<double>(),
-        pos["pieceIndex"]            .template as<int>(),
-        pos["inPieceDistance"]       .template as<double>(),
-        pos["lane"]["startLaneIndex"].template as<int>(),
-        pos["lane"]["endLaneIndex"]  .template as<int>(),
-      };
+      // every car of every tick has the same shape, so after the first one
+      // each lookup is a name compare at a remembered index
+      static thread_local key_paths paths;
+      const auto& name = paths.name.at(val).as_string();
+      const auto& color = paths.color.at(val).as_string();
+      CarPosition p;
+      copy_name(p.name, name.data(), name.size());
+      copy_name(p.color, color.data(), color.size());
+      p.angle           = paths.angle.at(val)          .template as<double>();
+      p.pieceIndex      = paths.pieceIndex.at(val)     .template as<int>();
+      p.inPieceDistance = paths.inPieceDistance.at(val).template as<double>();
+      p.startLane       = paths.startLane.at(val)      .template as<int>();
+      p.endLane         = paths.endLane.at(val)        .template as<int>();
+      const auto* lap   = paths.lap.find(val);
+      p.lap             = lap ? lap->template as<int>() : 0;
+      return p;
     }
+
+  private:
+    struct key_paths {
+      basic_key_path<char, Storage> name { "id", "name" };
+      basic_key_path<char, Storage> color { "id", "color" };
+      basic_key_path<char, Storage> angle { "angle" };
+      basic_key_path<char, Storage> pieceIndex { "piecePosition", "pieceIndex" };
+      basic_key_path<char, Storage> inPieceDistance { "piecePosition", "inPieceDistance" };
+      basic_key_path<char, Storage> startLane { "piecePosition", "lane", "startLaneIndex" };
+      basic_key_path<char, Storage> endLane { "piecePosition", "lane", "endLaneIndex" };
+      basic_key_path<char, Storage> lap { "piecePosition", "lap" };
+    };
 };
 
 }
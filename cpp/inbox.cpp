@@ -0,0 +1,56 @@
+#include "inbox.h"
+#include <jsoncons/json_view.hpp>
+
+using namespace hwo_protocol;
+
+inbox::inbox()
+  : kind(TREE),
+    msgtype(MSG_UNKNOWN)
+{
+}
+
+void inbox::decode(const char* line, size_t len)
+{
+  if (positions.decode(line, len)) {
+    kind = POSITIONS;
+    msgtype = MSG_CAR_POSITIONS;
+  } else if (game_init.decode(line, len, init)) {
+    kind = GAME_INIT;
+    msgtype = MSG_GAME_INIT;
+  } else {
+    jsoncons::json_arena::scope in_arena(arena);
+    parser.parse(line, len, msg);
+    kind = TREE;
+    msgtype = parse_msg_type(msg);
+  }
+}
+
+int inbox::tick() const
+{
+  switch (kind) {
+  case POSITIONS: return positions.positions().tick;
+  case GAME_INIT: return -1;
+  default: return jsoncons::view_of(msg).get("gameTick", -1);
+  }
+}
+
+const game_logic::msg_vector& inbox::react(game_logic& game)
+{
+  switch (kind) {
+  case POSITIONS: return game.react(positions.positions());
+  case GAME_INIT: return game.react(init);
+  default:
+    {
+      jsoncons::json_arena::scope in_arena(arena);
+      return game.react(msgtype, msg);
+    }
+  }
+}
+
+void inbox::release()
+{
+  if (kind == TREE) {
+    jsoncons::arena_json().swap(msg);
+    arena.release();
+  }
+}
@@ -0,0 +1,46 @@
+#ifndef HWO_INBOX_H
+#define HWO_INBOX_H
+
+#include "game_logic.h"
+#include "game_objs.h"
+#include "positions_decoder.h"
+#include "protocol.h"
+#include <jsoncons/json_parser.hpp>
+#include <jsoncons/arena_storage.hpp>
+#include <jsoncons/struct_decoder.hpp>
+
+// a received line made ready for game_logic, the same way for the bot and
+// for replays: carPositions is nearly every message and gameInit the
+// largest, so those two are decoded straight into structs; the rest take
+// the slow way through a json tree in an arena that is kept from message
+// to message. the counterpart of hwo_protocol::outbox.
+class inbox
+{
+public:
+  inbox();
+
+  // line is one message, the newline may be included
+  void decode(const char* line, size_t len);
+  // of the latest decode
+  hwo_protocol::msg_type type() const { return msgtype; }
+  int tick() const;
+
+  // the replies of game to the latest message; valid until game reacts again
+  const game_logic::msg_vector& react(game_logic& game);
+  // once the replies are sent
+  void release();
+
+private:
+  enum decoded_as { POSITIONS, GAME_INIT, TREE };
+
+  positions_decoder positions;
+  jsoncons::struct_decoder<GameInit> game_init;
+  GameInit init;
+  jsoncons::json_arena arena;
+  jsoncons::basic_json_parser<char, jsoncons::arena_storage<char>> parser;
+  jsoncons::arena_json msg;
+  decoded_as kind;
+  hwo_protocol::msg_type msgtype;
+};
+
+#endif
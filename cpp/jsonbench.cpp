@@ -0,0 +1,309 @@
+// throughput of jsoncons on the messages the bot sees: parsing into the
+// heap and into an arena, parsing only the members the bot uses, walking
+// the tree, the value_adapters of game_objs.h, decoding the same structs
+// straight from the text and serializing. each input is a json file (one message) or
+// a rawlog (every line the server sent). prints a table and appends the
+// numbers as one json line to the output file, so runs before and after a
+// parser change can be compared.
+//
+// ./jsonbench out.json label file...
+
+#include "game_objs.h"
+#include <jsoncons/json.hpp>
+#include <jsoncons/json_parser.hpp>
+#include <jsoncons/arena_storage.hpp>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace std;
+using namespace jsoncons;
+
+namespace
+{
+  typedef chrono::steady_clock clock_type;
+
+  // whole messages, one per line of a rawlog or one per json file
+  vector<string> load_messages(const string& filename)
+  {
+    ifstream in(filename);
+    vector<string> msgs;
+    if (filename.find("rawlog") == string::npos) {
+      stringstream ss;
+      ss << in.rdbuf();
+      if (!ss.str().empty())
+        msgs.push_back(ss.str());
+      return msgs;
+    }
+    // "<< " before what the server sent, "<<< " in older logs
+    string line;
+    while (getline(in, line)) {
+      size_t start = line.find_first_not_of('<');
+      if (start >= 2 && start != string::npos && line[start] == ' ' && start + 1 < line.size())
+        msgs.push_back(line.substr(start + 1));
+    }
+    return msgs;
+  }
+
+  // the fastest of several passes over the messages, in ns per pass; every
+  // pass is the messages repeated to about a millisecond of work
+  template <class F>
+  double best_pass(F f, size_t messages, size_t& repeat)
+  {
+    repeat = 1;
+    for (;;) {
+      auto t0 = clock_type::now();
+      for (size_t r = 0; r < repeat; r++)
+        for (size_t i = 0; i < messages; i++)
+          f(i);
+      double ns = chrono::duration<double, nano>(clock_type::now() - t0).count();
+      if (ns >= 1e6 || repeat >= (1u << 20))
+        break;
+      repeat *= 2;
+    }
+    double best = 1e300;
+    auto start = clock_type::now();
+    for (int pass = 0; pass < 5 || (pass < 50 && clock_type::now() - start < chrono::milliseconds(300)); pass++) {
+      auto t0 = clock_type::now();
+      for (size_t r = 0; r < repeat; r++)
+        for (size_t i = 0; i < messages; i++)
+          f(i);
+      best = min(best, chrono::duration<double, nano>(clock_type::now() - t0).count());
+    }
+    return best / repeat;
+  }
+
+  // reads every value the way game code would, so none of the tree is skipped
+  template <class Json>
+  double walk(const Json& val)
+  {
+    double sum = 0;
+    if (val.is_object()) {
+      for (auto it = val.begin_members(); it != val.end_members(); ++it)
+        sum += it->name().size() + walk(it->value());
+    } else if (val.is_array()) {
+      for (auto it = val.begin_elements(); it != val.end_elements(); ++it)
+        sum += walk(*it);
+    } else if (val.is_string()) {
+      sum += val.as_string().size();
+    } else if (val.is_number()) {
+      sum += val.as_double();
+    } else if (val.is_bool()) {
+      sum += val.as_bool();
+    }
+    return sum;
+  }
+
+  // the conversions game_logic makes: the track of a gameInit (or of a
+  // track file) and the cars of a carPositions; the number made
+  template <class Json>
+  int adapt(const Json& msg, double& sink)
+  {
+    const Json* track = nullptr;
+    if (msg.has_member("pieces"))
+      track = &msg;
+    else if (msg.has_member("msgType") && msg["msgType"].as_string() == "gameInit")
+      track = &msg["data"]["race"]["track"];
+    if (track) {
+      Track t = track->template as<Track>();
+      sink += t.track.size();
+      return 1;
+    }
+    if (msg.has_member("msgType") && msg["msgType"].as_string() == "carPositions") {
+      const Json& cars = msg["data"];
+      for (size_t i = 0; i < cars.size(); i++)
+        sink += cars[i].template as<CarPosition>().inPieceDistance;
+      return cars.size();
+    }
+    return 0;
+  }
+
+  // the same structs as adapt, read by the struct_decoders without a tree;
+  // which of them is told by the tree of the message
+  struct decoders
+  {
+    struct_decoder<Track> track;
+    struct_decoder<GameInit> init;
+    struct_decoder<CarPositions> positions;
+    Track t;
+    GameInit g;
+    CarPositions p;
+
+    enum kind { TRACK, GAME_INIT, CAR_POSITIONS };
+
+    static kind kind_of(const json& msg)
+    {
+      if (msg.has_member("pieces"))
+        return TRACK;
+      return msg["msgType"].as_string() == "gameInit" ? GAME_INIT : CAR_POSITIONS;
+    }
+
+    int decode(kind k, const string& msg, double& sink)
+    {
+      switch (k) {
+      case TRACK:
+        track.decode(msg, t);
+        sink += t.track.size();
+        return 1;
+      case GAME_INIT:
+        init.decode(msg, g);
+        sink += g.track.track.size();
+        return 1;
+      default:
+        positions.decode(msg, p);
+        for (int i = 0; i < p.ncars; i++)
+          sink += p.cars[i].inPieceDistance;
+        return p.ncars;
+      }
+    }
+  };
+
+  json stage(double ns_per_pass, size_t messages, size_t bytes)
+  {
+    json s;
+    s["ns_per_msg"] = ns_per_pass / messages;
+    s["mb_per_s"] = bytes / (ns_per_pass / 1e9) / 1e6;
+    return s;
+  }
+}
+
+int main(int argc, char* argv[])
+{
+  if (argc < 4) {
+    cerr << "usage: " << argv[0] << " out.json label file..." << endl;
+    return 1;
+  }
+  string out_file = argv[1];
+
+  json run;
+  run["label"] = string(argv[2]);
+  run["inputs"] = json(json::an_array);
+  double sink = 0;
+  cout << "input                     msgs    bytes   stage      ns/msg      MB/s" << endl;
+  for (int a = 3; a < argc; a++) {
+    string filename = argv[a];
+    vector<string> msgs = load_messages(filename);
+    if (msgs.empty()) {
+      cerr << filename << ": no messages" << endl;
+      continue;
+    }
+    size_t bytes = 0;
+    for (auto& m: msgs)
+      bytes += m.size();
+
+    vector<json> docs;
+    for (auto& m: msgs)
+      docs.push_back(json::parse_string(m));
+    size_t conversions = 0;
+    for (auto& d: docs)
+      conversions += adapt(d, sink);
+    size_t out_bytes = 0;
+    for (auto& d: docs)
+      out_bytes += d.to_string().size();
+
+    size_t repeat;
+    json result;
+    result["file"] = filename;
+    result["messages"] = msgs.size();
+    result["bytes"] = bytes;
+    result["conversions"] = conversions;
+
+    double parse = best_pass([&](size_t i) {
+      json val = json::parse_string(msgs[i]);
+      sink += val.size();
+    }, msgs.size(), repeat);
+    result["parse"] = stage(parse, msgs.size(), bytes);
+
+    // one parser for all, and the same keeping only what game_logic reads
+    json parsed;
+    json_parser everything;
+    double parser = best_pass([&](size_t i) {
+      everything.parse(msgs[i].data(), msgs[i].size(), parsed);
+      sink += parsed.size();
+    }, msgs.size(), repeat);
+    result["parser"] = stage(parser, msgs.size(), bytes);
+
+    json_parser track_members { { "pieces" }, { "lanes" } };
+    json_parser init_members { { "msgType" }, { "data", "race", "track" } };
+    json_parser positions_members { { "msgType" }, { "gameTick" }, { "data", "angle" },
+      { "data", "piecePosition" }, { "data", "id", "color" } };
+    vector<json_parser*> projections;
+    for (auto& d: docs) {
+      if (d.has_member("pieces"))
+        projections.push_back(&track_members);
+      else if (d.has_member("msgType") && d["msgType"].as_string() == "gameInit")
+        projections.push_back(&init_members);
+      else if (d.has_member("msgType") && d["msgType"].as_string() == "carPositions")
+        projections.push_back(&positions_members);
+      else
+        projections.push_back(&everything);
+    }
+    double projection = best_pass([&](size_t i) {
+      projections[i]->parse(msgs[i].data(), msgs[i].size(), parsed);
+      sink += parsed.size();
+    }, msgs.size(), repeat);
+    result["projection"] = stage(projection, msgs.size(), bytes);
+
+    // as main.cpp's loop does it
+    json_arena arena;
+    {
+      json_arena::scope in_arena(arena);
+      basic_json_parser<char, arena_storage<char>> parser;
+      arena_json val;
+      double parse_arena = best_pass([&](size_t i) {
+        parser.parse(msgs[i].data(), msgs[i].size(), val);
+        sink += val.size();
+        arena_json().swap(val);
+        arena.release();
+      }, msgs.size(), repeat);
+      result["parse_arena"] = stage(parse_arena, msgs.size(), bytes);
+    }
+
+    double access = best_pass([&](size_t i) { sink += walk(docs[i]); }, msgs.size(), repeat);
+    result["access"] = stage(access, msgs.size(), bytes);
+
+    // only the messages that convert to something
+    vector<size_t> convertible;
+    for (size_t i = 0; i < docs.size(); i++)
+      if (adapt(docs[i], sink) > 0)
+        convertible.push_back(i);
+    if (!convertible.empty()) {
+      size_t convertible_bytes = 0;
+      for (size_t i: convertible)
+        convertible_bytes += msgs[i].size();
+      double adapter = best_pass([&](size_t i) { adapt(docs[convertible[i]], sink); }, convertible.size(), repeat);
+      result["adapter"] = stage(adapter, convertible.size(), convertible_bytes);
+      result["adapter"]["messages"] = convertible.size();
+
+      decoders dec;
+      vector<decoders::kind> kinds;
+      for (size_t i: convertible)
+        kinds.push_back(decoders::kind_of(docs[i]));
+      double decode = best_pass([&](size_t i) { dec.decode(kinds[i], msgs[convertible[i]], sink); }, convertible.size(), repeat);
+      result["decode"] = stage(decode, convertible.size(), convertible_bytes);
+      result["decode"]["messages"] = convertible.size();
+    }
+
+    double serialize = best_pass([&](size_t i) { sink += docs[i].to_string().size(); }, msgs.size(), repeat);
+    result["serialize"] = stage(serialize, msgs.size(), out_bytes);
+
+    const char* stages[] = { "parse", "parser", "projection", "parse_arena", "access", "adapter", "decode", "serialize" };
+    for (const char* s: stages) {
+      if (!result.has_member(s))
+        continue;
+      string shown = filename.size() > 24 ? "..." + filename.substr(filename.size() - 21) : filename;
+      printf("%-24s %6zu %8zu   %-11s %9.0f %9.1f\n", shown.c_str(), msgs.size(), bytes, s,
+        result[s]["ns_per_msg"].as<double>(), result[s]["mb_per_s"].as<double>());
+    }
+    run["inputs"].add(result);
+  }
+
+  ofstream out(out_file, ios::app);
+  out << run.to_string() << endl;
+  // keeps the work from being optimized away
+  return sink == 42.5 ? 2 : 0;
+}
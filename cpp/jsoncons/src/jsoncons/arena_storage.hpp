@@ -0,0 +1,224 @@
+// Copyright 2013 Daniel Parker
+// Distributed under the Boost license, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+// See https://sourceforge.net/projects/jsoncons/files/ for latest version
+// See https://sourceforge.net/p/jsoncons/wiki/Home/ for documentation.
+
+#ifndef JSONCONS_ARENA_STORAGE_HPP
+#define JSONCONS_ARENA_STORAGE_HPP
+
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#include <vector>
+#include "jsoncons/json1.hpp"
+
+namespace jsoncons {
+
+// A bump allocator for the values of one document. Memory is handed out
+// from large blocks and never given back one piece at a time; release()
+// rewinds to the start of the first block in O(1) and keeps the blocks, so
+// once the blocks are big enough for the largest document parsing does
+// not call malloc at all.
+//
+// Values of arena_storage allocate from the arena of the innermost live
+// json_arena::scope on the thread, or from a process wide arena that is
+// never released when there is none. A document must be destroyed (or
+// swapped out) before its arena is released.
+class json_arena
+{
+public:
+    static const size_t default_block_size = 64 * 1024;
+
+    explicit json_arena(size_t block_size = default_block_size)
+        : block_size_(block_size), block_(0), base_(0), size_(0), used_(0)
+    {
+    }
+
+    ~json_arena()
+    {
+        for (size_t i = 0; i < blocks_.size(); ++i)
+        {
+            std::free(blocks_[i].data);
+        }
+    }
+
+    void* allocate(size_t n, size_t align)
+    {
+        size_t at = (used_ + align - 1) & ~(align - 1);
+        if (at + n > size_)
+        {
+            return allocate_slow(n,align);
+        }
+        used_ = at + n;
+        return base_ + at;
+    }
+
+    // Everything allocated so far becomes free again
+    void release()
+    {
+        block_ = 0;
+        base_ = blocks_.size() > 0 ? blocks_[0].data : 0;
+        size_ = blocks_.size() > 0 ? blocks_[0].size : 0;
+        used_ = 0;
+    }
+
+    size_t blocks() const
+    {
+        return blocks_.size();
+    }
+
+    size_t capacity() const
+    {
+        size_t total = 0;
+        for (size_t i = 0; i < blocks_.size(); ++i)
+        {
+            total += blocks_[i].size;
+        }
+        return total;
+    }
+
+    // Makes an arena the one arena_storage allocates from until the
+    // scope ends
+    class scope
+    {
+    public:
+        explicit scope(json_arena& arena)
+            : previous_(current_ref())
+        {
+            current_ref() = &arena;
+        }
+        ~scope()
+        {
+            current_ref() = previous_;
+        }
+    private:
+        scope(const scope&);
+        scope& operator=(const scope&);
+
+        json_arena* previous_;
+    };
+
+    static json_arena& current()
+    {
+        json_arena* p = current_ref();
+        if (p == 0)
+        {
+            static json_arena fallback;
+            p = &fallback;
+        }
+        return *p;
+    }
+
+private:
+    json_arena(const json_arena&);
+    json_arena& operator=(const json_arena&);
+
+    struct block
+    {
+        char* data;
+        size_t size;
+    };
+
+    static json_arena*& current_ref()
+    {
+        static thread_local json_arena* current = 0;
+        return current;
+    }
+
+    void* allocate_slow(size_t n, size_t align)
+    {
+        // the next kept block that fits, else a new one at the end
+        size_t next = blocks_.size() > 0 ? block_ + 1 : 0;
+        while (next < blocks_.size() && blocks_[next].size < n + align)
+        {
+            ++next;
+        }
+        if (next == blocks_.size())
+        {
+            block b;
+            b.size = n + align > block_size_ ? n + align : block_size_;
+            b.data = static_cast<char*>(std::malloc(b.size));
+            if (b.data == 0)
+            {
+                throw std::bad_alloc();
+            }
+            blocks_.push_back(b);
+        }
+        block_ = next;
+        base_ = blocks_[next].data;
+        size_ = blocks_[next].size;
+        used_ = 0;
+        return allocate(n,align);
+    }
+
+    size_t block_size_;
+    std::vector<block> blocks_;
+    size_t block_;
+    char* base_;
+    size_t size_;
+    size_t used_;
+};
+
+// Stateless, so every instance is equal; deallocate does nothing and the
+// memory comes back with json_arena::release
+template <class T>
+class json_arena_allocator
+{
+public:
+    typedef T value_type;
+
+    template <class U>
+    struct rebind
+    {
+        typedef json_arena_allocator<U> other;
+    };
+
+    json_arena_allocator()
+    {
+    }
+
+    template <class U>
+    json_arena_allocator(const json_arena_allocator<U>&)
+    {
+    }
+
+    T* allocate(size_t n)
+    {
+        return static_cast<T*>(json_arena::current().allocate(n*sizeof(T),alignof(T)));
+    }
+
+    void deallocate(T*, size_t)
+    {
+    }
+
+    template <class U>
+    bool operator==(const json_arena_allocator<U>&) const
+    {
+        return true;
+    }
+
+    template <class U>
+    bool operator!=(const json_arena_allocator<U>&) const
+    {
+        return false;
+    }
+};
+
+// Storage policy that puts the nodes, vectors and string values of a
+// document in the current json_arena. Member names stay std::basic_string,
+// short ones live inside the member without allocating.
+template <typename Char>
+struct arena_storage
+{
+    template <class T>
+    using allocator = json_arena_allocator<T>;
+};
+
+typedef basic_json<char,arena_storage<char>> arena_json;
+typedef basic_json<wchar_t,arena_storage<wchar_t>> arena_wjson;
+
+}
+
+#endif
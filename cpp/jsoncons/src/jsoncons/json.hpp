@@ -10,5 +10,6 @@
 
 #include "jsoncons/json1.hpp"
 #include "jsoncons/json2.hpp"
+#include "jsoncons/json_parser.hpp"
 
 #endif
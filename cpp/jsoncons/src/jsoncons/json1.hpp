@@ -15,17 +15,51 @@
 #include <cstdlib>
 #include <cstring>
 #include <ostream>
+#include <memory>
+#include <new>
+#include <utility>
 #include "jsoncons/jsoncons.hpp"
 #include "jsoncons/json_output_handler.hpp"
 #include "jsoncons/output_format.hpp"
+#include "jsoncons/key_table.hpp"
 
 namespace jsoncons {
 
+// The Storage policy of basic_json says where the object and array nodes,
+// their member and element vectors and the string values are allocated.
+// This one uses the heap; see arena_storage.hpp for another.
 template <typename Char>
 struct storage
 {
+    template <class T>
+    using allocator = std::allocator<T>;
 };
 
+template <class Storage,class T,class... Args>
+T* create_instance(Args&&... args)
+{
+    typename Storage::template allocator<T> alloc;
+    T* p = alloc.allocate(1);
+    try
+    {
+        ::new(static_cast<void*>(p)) T(std::forward<Args>(args)...);
+    }
+    catch (...)
+    {
+        alloc.deallocate(p,1);
+        throw;
+    }
+    return p;
+}
+
+template <class Storage,class T>
+void destroy_instance(T* p)
+{
+    typename Storage::template allocator<T> alloc;
+    p->~T();
+    alloc.deallocate(p,1);
+}
+
 template <typename Char,class T> inline
 void serialize(basic_json_output_handler<Char>& os, const T& val)
 {
@@ -109,7 +143,8 @@ public:
         ulonglong_t,
         bool_t,
         null_t,
-        custom_t
+        custom_t,
+        small_string_t
     };
 };
 
@@ -119,6 +154,7 @@ class basic_json : public json_base
 public:
     typedef Char char_type;
     typedef Storage allocator_type;
+    typedef std::basic_string<Char,std::char_traits<Char>,typename Storage::template allocator<Char>> string_storage_type;
 
     typedef jsoncons::null_type null_type;
     class object;
@@ -135,22 +171,33 @@ public:
             : name_(pair.name_), value_(pair.value_)
         {
         }
-        member_type(member_type&& pair)
-            //: name_(std::move(pair.name_)), value_(std::move(pair.value_))
+        // noexcept, or a vector of members copies every member, and all
+        // that is under it, each time it grows
+        member_type(member_type&& pair) noexcept
+            : name_(std::move(pair.name_)), value_(std::move(pair.value_))
         {
-            name_.swap(pair.name_);
-            value_.swap(pair.value_);
         }
         member_type(const std::basic_string<Char>& nam, const basic_json<Char,Storage>& val)
             : name_(nam), value_(val)
         {
         }
         member_type(std::basic_string<Char>&& nam, basic_json<Char,Storage>&& val)
-            : name_(nam), value_(val)
+            : name_(nam)
+        {
+            value_.swap(val);
+        }
+        member_type(basic_json_key<Char>&& key, basic_json<Char,Storage>&& val)
         {
+            name_.swap(key);
+            value_.swap(val);
         }
 
         const std::basic_string<Char>& name() const
+        {
+            return name_.str();
+        }
+
+        const basic_json_key<Char>& key() const
         {
             return name_;
         }
@@ -171,13 +218,13 @@ public:
             return *this;
         }
 
-        void swap(member_type& pair)
+        void swap(member_type& pair) noexcept
         {
             name_.swap(pair.name_);
             value_.swap(pair.value_);
         }
 
-        std::basic_string<Char> name_;
+        basic_json_key<Char> name_;
         basic_json<Char,Storage> value_;
     };
 
@@ -910,6 +957,8 @@ public:
 
     static basic_json parse(std::basic_istream<Char>& is);
 
+    static basic_json parse(const Char* s, size_t length);
+
     static basic_json parse_string(const std::basic_string<Char>& s);
 
     static basic_json parse_file(const std::string& s);
@@ -1055,7 +1104,7 @@ public:
 
     bool is_string() const
     {
-        return type_ == string_t;
+        return type_ == string_t || type_ == small_string_t;
     }
 
     bool is_numeric() const
@@ -1166,7 +1215,7 @@ public:
     void remove_member(const std::basic_string<Char>& name);
     // Removes a member from an object value
 
-    basic_json(basic_json&& val);
+    basic_json(basic_json&& val) noexcept;
 
     template <typename T>
     void set(const std::basic_string<Char>& name, T value)
@@ -1175,7 +1224,7 @@ public:
         {
         case empty_object_t:
             type_ = object_t;
-            value_.object_ = new json_object<Char,Storage>();
+            value_.object_ = create_instance<Storage,json_object<Char,Storage>>();
         case object_t:
             {
                 value_adapter<Char,Storage,T> adapter;
@@ -1255,12 +1304,12 @@ public:
 
     value_type type() const
     {
-        return type_;
+        return type_ == small_string_t ? string_t : type_;
     }
 
     void to_stream(basic_json_output_handler<Char>& handler) const;
 
-    void swap(basic_json<Char,Storage>& b)
+    void swap(basic_json<Char,Storage>& b) noexcept
     {
         using std::swap;
 
@@ -1360,7 +1409,58 @@ private:
         }
     };
 
+    // string values are held with the Storage allocator, the handlers and
+    // as_string deal in plain std::basic_string
+    static const std::basic_string<Char>& std_string(const std::basic_string<Char>& s)
+    {
+        return s;
+    }
+    template <class Alloc>
+    static std::basic_string<Char> std_string(const std::basic_string<Char,std::char_traits<Char>,Alloc>& s)
+    {
+        return std::basic_string<Char>(s.data(),s.size());
+    }
+
+    // Strings that fit in the value itself, such as the colors of cars and
+    // "Left" or "Right", are kept there as a small_string_t and allocate
+    // nothing. type() reports them as string_t.
+    static const size_t small_string_capacity = (sizeof(double) - 1)/sizeof(Char);
+
+    struct small_string_data
+    {
+        Char data_[small_string_capacity];
+        unsigned char length_;
+    };
+
+    void init_string(const Char* s, size_t length)
+    {
+        if (length <= small_string_capacity)
+        {
+            type_ = small_string_t;
+            std::char_traits<Char>::copy(value_.small_string_.data_,s,length);
+            value_.small_string_.length_ = static_cast<unsigned char>(length);
+        }
+        else
+        {
+            type_ = string_t;
+            value_.value_string_ = create_instance<Storage,string_storage_type>(s,length);
+        }
+    }
+
+    const Char* string_data() const
+    {
+        return type_ == small_string_t ? value_.small_string_.data_ : value_.value_string_->data();
+    }
+
+    size_t string_length() const
+    {
+        return type_ == small_string_t ? value_.small_string_.length_ : value_.value_string_->length();
+    }
+
 	value_type type_;
+    // zeroed before any constructor sets a member, so that swapping or
+    // moving a value whose type uses no member (null, empty object, bool
+    // and the rest of the inline bytes) copies defined bits
     union
     {
         double value_double_;
@@ -1369,9 +1469,10 @@ private:
         bool bool_value_;
         json_object<Char,Storage>* object_;
         json_array<Char,Storage>* array_;
-        std::basic_string<Char>* value_string_;
+        string_storage_type* value_string_;
+        small_string_data small_string_;
         basic_custom_data<Char>* userdata_;
-    } value_;
+    } value_ = {};
 };
 
 template <typename Char, typename Storage>
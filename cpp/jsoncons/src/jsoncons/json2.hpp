@@ -49,7 +49,7 @@ template <class InputIterator>
 basic_json<Char,Storage>::basic_json(InputIterator first, InputIterator last)
 {
     type_ = array_t;
-    value_.array_ = new json_array<Char,Storage>(first,last);
+    value_.array_ = create_instance<Storage,json_array<Char,Storage>>(first,last);
 }
 
 template <typename Char, typename Storage>
@@ -65,10 +65,11 @@ basic_json<Char,Storage>::basic_json(const basic_json<Char,Storage>& val)
     case longlong_t:
     case ulonglong_t:
     case bool_t:
+    case small_string_t:
         value_ = val.value_;
         break;
     case string_t:
-        value_.value_string_ = new std::basic_string<Char>(*(val.value_.value_string_));
+        value_.value_string_ = create_instance<Storage,string_storage_type>(*(val.value_.value_string_));
         break;
     case array_t:
         value_.array_ = val.value_.array_->clone();
@@ -165,23 +166,19 @@ basic_json<Char,Storage>::basic_json(bool val)
 template <typename Char, typename Storage>
 basic_json<Char,Storage>::basic_json(Char c)
 {
-    type_ = string_t;
-    value_.value_string_ = new std::basic_string<Char>();
-    value_.value_string_->push_back(c);
+    init_string(&c,1);
 }
 
 template <typename Char, typename Storage>
 basic_json<Char,Storage>::basic_json(const std::basic_string<Char>& s)
 {
-    type_ = string_t;
-    value_.value_string_ = new std::basic_string<Char>(s);
+    init_string(s.data(),s.size());
 }
 
 template <typename Char, typename Storage>
 basic_json<Char,Storage>::basic_json(const Char* s)
 {
-    type_ = string_t;
-    value_.value_string_ = new std::basic_string<Char>(s);
+    init_string(s,std::char_traits<Char>::length(s));
 }
 
 template <typename Char, typename Storage>
@@ -198,13 +195,14 @@ basic_json<Char,Storage>::basic_json(value_type t)
     case bool_t:
         break;
     case string_t:
-        value_.value_string_ = new std::basic_string<Char>();
+    case small_string_t:
+        init_string(0,0);
         break;
     case array_t:
-        value_.array_ = new json_array<Char,Storage>();
+        value_.array_ = create_instance<Storage,json_array<Char,Storage>>();
         break;
     case object_t:
-        value_.object_ = new json_object<Char,Storage>();
+        value_.object_ = create_instance<Storage,json_object<Char,Storage>>();
         break;
 
     case custom_t:
@@ -223,15 +221,16 @@ basic_json<Char,Storage>::~basic_json()
     case longlong_t:
     case ulonglong_t:
     case bool_t:
+    case small_string_t:
         break;
     case string_t:
-        delete value_.value_string_;
+        destroy_instance<Storage>(value_.value_string_);
         break;
     case array_t:
-        delete value_.array_;
+        destroy_instance<Storage>(value_.array_);
         break;
     case object_t:
-        delete value_.object_;
+        destroy_instance<Storage>(value_.object_);
         break;
     case custom_t:
         delete value_.userdata_;
@@ -249,8 +248,8 @@ void basic_json<Char,Storage>::assign_string(const std::basic_string<Char>& rhs)
 	case longlong_t:
     case ulonglong_t:
 	case double_t:
-        type_ = string_t;
-        value_.value_string_ = new std::basic_string<Char>(rhs);
+    case small_string_t:
+        init_string(rhs.data(),rhs.size());
         break;
     default:
         basic_json<Char,Storage>(rhs).swap(*this);
@@ -409,7 +408,7 @@ bool basic_json<Char,Storage>::operator==(const basic_json<Char,Storage>& rhs) c
         }
     }
 
-    if (rhs.type_ != type_)
+    if (rhs.type() != type())
     {
         return false;
     }
@@ -421,7 +420,9 @@ bool basic_json<Char,Storage>::operator==(const basic_json<Char,Storage>& rhs) c
     case empty_object_t:
         return true;
     case string_t:
-        return *(value_.value_string_) == *(rhs.value_.value_string_);
+    case small_string_t:
+        return string_length() == rhs.string_length() &&
+               std::char_traits<Char>::compare(string_data(),rhs.string_data(),string_length()) == 0;
     case array_t:
         return *(value_.array_) == *(rhs.value_.array_);
         break;
@@ -546,7 +547,7 @@ void basic_json<Char,Storage>::set(const std::basic_string<Char>& name, const ba
     {
     case empty_object_t:
         type_ = object_t;
-        value_.object_ = new json_object<Char,Storage>();
+        value_.object_ = create_instance<Storage,json_object<Char,Storage>>();
     case object_t:
         value_.object_->set(name,value);
         break;
@@ -558,7 +559,7 @@ void basic_json<Char,Storage>::set(const std::basic_string<Char>& name, const ba
 }
 
 template <typename Char, typename Storage>
-basic_json<Char,Storage>::basic_json(basic_json&& other)
+basic_json<Char,Storage>::basic_json(basic_json&& other) noexcept
 {
     type_ = other.type_;
     value_ = other.value_;
@@ -602,7 +603,7 @@ void basic_json<Char,Storage>::set(std::basic_string<Char>&& name, basic_json<Ch
     {
     case empty_object_t:
         type_ = object_t;
-        value_.object_ = new json_object<Char,Storage>();
+        value_.object_ = create_instance<Storage,json_object<Char,Storage>>();
     case object_t:
         value_.object_->set(name,value);
         break;
@@ -621,7 +622,7 @@ void basic_json<Char,Storage>::set_custom_data(const std::basic_string<Char>& na
     {
     case empty_object_t:
         type_ = object_t;
-        value_.object_ = new json_object<Char,Storage>();
+        value_.object_ = create_instance<Storage,json_object<Char,Storage>>();
     case object_t:
         value_.object_->set(name,basic_json<Char,Storage>(new custom_data_wrapper<Char,T>(value)));
         break;
@@ -802,7 +803,10 @@ void basic_json<Char,Storage>::to_stream(basic_json_output_handler<Char>& handle
     switch (type_)
     {
     case string_t:
-        handler.value(*(value_.value_string_));
+        handler.value(std_string(*(value_.value_string_)));
+        break;
+    case small_string_t:
+        handler.value(std::basic_string<Char>(value_.small_string_.data_,value_.small_string_.length_));
         break;
     case double_t:
         handler.value(value_.value_double_);
@@ -877,10 +881,10 @@ void basic_json<Char,Storage>::to_stream(std::basic_ostream<Char>& os, const bas
 }
 
 template <typename Char, typename Storage>
-const basic_json<Char,Storage> basic_json<Char,Storage>::an_object(new json_object<Char,Storage>());
+const basic_json<Char,Storage> basic_json<Char,Storage>::an_object(create_instance<Storage,json_object<Char,Storage>>());
 
 template <typename Char, typename Storage>
-const basic_json<Char,Storage> basic_json<Char,Storage>::an_array(new json_array<Char,Storage>());
+const basic_json<Char,Storage> basic_json<Char,Storage>::an_array(create_instance<Storage,json_array<Char,Storage>>());
 
 template <typename Char, typename Storage>
 const basic_json<Char,Storage> basic_json<Char,Storage>::null = basic_json<Char,Storage>(jsoncons::null_type());
@@ -888,25 +892,25 @@ const basic_json<Char,Storage> basic_json<Char,Storage>::null = basic_json<Char,
 template <typename Char, typename Storage>
 basic_json<Char,Storage> basic_json<Char,Storage>::make_array()
 {
-    return basic_json<Char,Storage>(new json_array<Char,Storage>());
+    return basic_json<Char,Storage>(create_instance<Storage,json_array<Char,Storage>>());
 }
 
 template <typename Char, typename Storage>
 basic_json<Char,Storage> basic_json<Char,Storage>::make_array(size_t n)
 {
-    return basic_json<Char,Storage>(new json_array<Char,Storage>(n));
+    return basic_json<Char,Storage>(create_instance<Storage,json_array<Char,Storage>>(n));
 }
 
 template <typename Char, typename Storage>
 basic_json<Char,Storage> basic_json<Char,Storage>::make_array(size_t n, const basic_json<Char,Storage>& val)
 {
-    return basic_json<Char,Storage>(new json_array<Char,Storage>(n,val));
+    return basic_json<Char,Storage>(create_instance<Storage,json_array<Char,Storage>>(n,val));
 }
 
 template <typename Char, typename Storage>
 basic_json<Char,Storage> basic_json<Char,Storage>::make_2d_array(size_t m, size_t n)
 {
-    basic_json<Char,Storage> a(basic_json<Char,Storage>(new json_array<Char,Storage>(m)));
+    basic_json<Char,Storage> a(basic_json<Char,Storage>(create_instance<Storage,json_array<Char,Storage>>(m)));
     for (size_t i = 0; i < a.size(); ++i)
     {
         a[i] = basic_json<Char,Storage>::make_array(n);
@@ -917,7 +921,7 @@ basic_json<Char,Storage> basic_json<Char,Storage>::make_2d_array(size_t m, size_
 template <typename Char, typename Storage>
 basic_json<Char,Storage> basic_json<Char,Storage>::make_2d_array(size_t m, size_t n, const basic_json<Char,Storage>& val)
 {
-    basic_json<Char,Storage> a(basic_json<Char,Storage>(new json_array<Char,Storage>(m)));
+    basic_json<Char,Storage> a(basic_json<Char,Storage>(create_instance<Storage,json_array<Char,Storage>>(m)));
     for (size_t i = 0; i < a.size(); ++i)
     {
         a[i] = basic_json<Char,Storage>::make_array(n,val);
@@ -928,7 +932,7 @@ basic_json<Char,Storage> basic_json<Char,Storage>::make_2d_array(size_t m, size_
 template <typename Char, typename Storage>
 basic_json<Char,Storage> basic_json<Char,Storage>::make_3d_array(size_t m, size_t n, size_t k)
 {
-    basic_json<Char,Storage> a(basic_json<Char,Storage>(new json_array<Char,Storage>(m)));
+    basic_json<Char,Storage> a(basic_json<Char,Storage>(create_instance<Storage,json_array<Char,Storage>>(m)));
     for (size_t i = 0; i < a.size(); ++i)
     {
         a[i] = basic_json<Char,Storage>::make_2d_array(n,k);
@@ -939,7 +943,7 @@ basic_json<Char,Storage> basic_json<Char,Storage>::make_3d_array(size_t m, size_
 template <typename Char, typename Storage>
 basic_json<Char,Storage> basic_json<Char,Storage>::make_3d_array(size_t m, size_t n, size_t k, const basic_json<Char,Storage>& val)
 {
-    basic_json<Char,Storage> a(basic_json<Char,Storage>(new json_array<Char,Storage>(m)));
+    basic_json<Char,Storage> a(basic_json<Char,Storage>(create_instance<Storage,json_array<Char,Storage>>(m)));
     for (size_t i = 0; i < a.size(); ++i)
     {
         a[i] = basic_json<Char,Storage>::make_2d_array(n,k,val);
@@ -959,17 +963,22 @@ basic_json<Char,Storage> basic_json<Char,Storage>::parse(std::basic_istream<Char
 }
 
 template <typename Char, typename Storage>
-basic_json<Char,Storage> basic_json<Char,Storage>::parse_string(const std::basic_string<Char>& s)
+basic_json<Char,Storage> basic_json<Char,Storage>::parse(const Char* s, size_t length)
 {
-    std::basic_istringstream<Char> is(s);
     basic_json_deserializer<Char,Storage> handler;
-    basic_json_reader<Char> parser(is,handler);
-    parser.read();
+    basic_json_reader<Char> parser(handler);
+    parser.read(s,length);
     basic_json<Char,Storage> val;
     handler.root().swap(val);
     return val;
 }
 
+template <typename Char, typename Storage>
+basic_json<Char,Storage> basic_json<Char,Storage>::parse_string(const std::basic_string<Char>& s)
+{
+    return parse(s.data(),s.length());
+}
+
 template <typename Char, typename Storage>
 basic_json<Char,Storage> basic_json<Char,Storage>::parse_file(const std::string& filename)
 {
@@ -994,7 +1003,7 @@ typename basic_json<Char,Storage>::object_iterator basic_json<Char,Storage>::beg
     {
     case empty_object_t:
         type_ = object_t;
-        value_.object_ = new json_object<Char,Storage>();
+        value_.object_ = create_instance<Storage,json_object<Char,Storage>>();
     case object_t:
         return value_.object_->begin();
     default:
@@ -1023,7 +1032,7 @@ typename basic_json<Char,Storage>::object_iterator basic_json<Char,Storage>::end
     {
     case empty_object_t:
         type_ = object_t;
-        value_.object_ = new json_object<Char,Storage>();
+        value_.object_ = create_instance<Storage,json_object<Char,Storage>>();
     case object_t:
         return value_.object_->end();
     default:
@@ -1117,7 +1126,8 @@ bool basic_json<Char,Storage>::is_empty() const
     switch (type_)
     {
     case string_t:
-        return value_.value_string_->size() == 0;
+    case small_string_t:
+        return string_length() == 0;
     case array_t:
         return value_.array_->size() == 0;
     case empty_object_t:
@@ -1139,7 +1149,7 @@ void basic_json<Char,Storage>::reserve(size_t n)
         break;
     case empty_object_t:
         type_ = object_t;
-        value_.object_ = new json_object<Char,Storage>();
+        value_.object_ = create_instance<Storage,json_object<Char,Storage>>();
     case object_t:
         value_.object_->reserve(n);
         break;
@@ -1353,7 +1363,9 @@ std::basic_string<Char> basic_json<Char,Storage>::as_string() const
     switch (type_)
     {
     case string_t:
-        return *(value_.value_string_);
+        return std_string(*(value_.value_string_));
+    case small_string_t:
+        return std::basic_string<Char>(value_.small_string_.data_,value_.small_string_.length_);
     default:
         return to_string();
     }
@@ -1365,7 +1377,9 @@ std::basic_string<Char> basic_json<Char,Storage>::as_string(const basic_output_f
     switch (type_)
     {
     case string_t:
-        return *(value_.value_string_);
+        return std_string(*(value_.value_string_));
+    case small_string_t:
+        return std::basic_string<Char>(value_.small_string_.data_,value_.small_string_.length_);
     default:
         return to_string(format);
     }
@@ -1377,7 +1391,8 @@ Char basic_json<Char,Storage>::as_char() const
     switch (type_)
     {
     case string_t:
-        return value_.value_string_->length() > 0 ? (*value_.value_string_)[0] : '\0';
+    case small_string_t:
+        return string_length() > 0 ? string_data()[0] : '\0';
     case longlong_t:
         return static_cast<Char>(value_.longlong_value_);
     case ulonglong_t:
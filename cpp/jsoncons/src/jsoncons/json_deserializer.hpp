@@ -32,12 +32,12 @@ class basic_json_deserializer : public basic_json_input_handler<Char>
             minimum_structure_capacity_ = minimum_structure_capacity;
             if (is_object_)
             {
-                object_ = new json_object<Char,Storage>();
+                object_ = create_instance<Storage,json_object<Char,Storage>>();
                 object_->reserve(minimum_structure_capacity);
             }
             else
             {
-                array_ = new json_array<Char,Storage>();
+                array_ = create_instance<Storage,json_array<Char,Storage>>();
                 array_->reserve(minimum_structure_capacity);
             }
         }
@@ -48,11 +48,11 @@ class basic_json_deserializer : public basic_json_input_handler<Char>
             {
                 if (is_object_)
                 {
-                    delete object_;
+                    destroy_instance<Storage>(object_);
                 }
                 else
                 {
-                    delete array_;
+                    destroy_instance<Storage>(array_);
                 }
             }
             catch (...)
@@ -74,7 +74,7 @@ class basic_json_deserializer : public basic_json_input_handler<Char>
 
         json_array<Char,Storage>* release_array() {json_array<Char,Storage>* p(0); std::swap(p,array_); return p;}
 
-        std::basic_string<Char> name_;
+        basic_json_key<Char> name_;
         bool is_object_;
         json_object<Char,Storage>* object_;
         json_array<Char,Storage>* array_;
@@ -153,7 +153,7 @@ public:
 
     virtual void name(const std::basic_string<Char>& name, const basic_parsing_context<Char>& context)
     {
-        stack_.back().name_ = name;
+        stack_.back().name_ = keys_.get(name.data(),name.size());
     }
 
     virtual void null_value(const basic_parsing_context<Char>& context)
@@ -173,6 +173,17 @@ public:
         return root_;
     }
 
+    // Drops the root and whatever a failed parse left behind, for reuse
+    void reset()
+    {
+        for (size_t i = 0; i < stack_.size(); ++i)
+        {
+            stack_[i].destroy();
+        }
+        stack_.clear();
+        basic_json<Char,Storage>().swap(root_);
+    }
+
 // value(...) implementation
 
     virtual void string_value(const std::basic_string<Char>& value, const basic_parsing_context<Char>& context)
@@ -238,6 +249,7 @@ public:
 private:
 	basic_json<Char,Storage> root_;
     std::vector<stack_item> stack_;
+    basic_key_cache<Char> keys_;
 };
 
 typedef basic_json_deserializer<char,storage<char>> json_deserializer;
@@ -9,6 +9,9 @@
 #define JSONCONS_JSON_FILTER_HPP
 
 #include <string>
+#include <vector>
+#include <utility>
+#include <initializer_list>
 
 #include "jsoncons/json_input_handler.hpp"
 #include "jsoncons/json_output_handler.hpp"
@@ -162,6 +165,11 @@ public:
         return parent_;
     }
 
+    virtual bool skip_value()
+    {
+        return parent_.skip_value();
+    }
+
 // value(...) implementation
     virtual void string_value(const std::basic_string<Char>& value, const basic_parsing_context<Char>& context)
     {
@@ -195,6 +203,246 @@ private:
 typedef basic_json_filter<char> json_filter;
 typedef basic_json_filter<wchar_t> wjson_filter;
 
+// Passes on only the members on the key paths it keeps, and everything
+// below their ends, e.g. keeping {"msgType"} and {"data","race","track"}
+// of a message. The elements of an array are all under the name of the
+// array. basic_json_reader moves past the rest without reading it; from
+// other sources it is dropped here. Keeping no paths keeps everything.
+template <typename Char>
+class basic_json_projection : public basic_json_filter<Char>
+{
+    struct node
+    {
+        node()
+            : all_(false)
+        {
+        }
+
+        std::vector<std::pair<std::basic_string<Char>,size_t>> members_;
+        bool all_; // the end of a path
+    };
+
+    struct frame
+    {
+        size_t node_;
+        bool array_;
+    };
+public:
+    basic_json_projection(basic_json_input_handler<Char>& parent)
+        : basic_json_filter<Char>(parent), nodes_(1), next_(0), drop_(false), depth_(0)
+    {
+        nodes_[0].all_ = true;
+    }
+
+    basic_json_projection(basic_json_input_handler<Char>& parent,
+                          std::initializer_list<std::initializer_list<const Char*>> paths)
+        : basic_json_filter<Char>(parent), nodes_(1), next_(0), drop_(false), depth_(0)
+    {
+        for (typename std::initializer_list<std::initializer_list<const Char*>>::iterator it = paths.begin(); it != paths.end(); ++it)
+        {
+            keep(std::vector<std::basic_string<Char>>(it->begin(),it->end()));
+        }
+    }
+
+    void keep(const std::vector<std::basic_string<Char>>& path)
+    {
+        if (nodes_.size() == 1)
+        {
+            nodes_[0].all_ = false;
+        }
+        size_t n = 0;
+        for (size_t i = 0; i < path.size(); ++i)
+        {
+            size_t child = member(n,path[i].data(),path[i].size());
+            if (child == 0)
+            {
+                child = nodes_.size();
+                nodes_[n].members_.push_back(std::make_pair(path[i],child));
+                nodes_.push_back(node());
+            }
+            n = child;
+        }
+        nodes_[n].all_ = true;
+    }
+
+    virtual void begin_json()
+    {
+        stack_.clear();
+        next_ = 0;
+        drop_ = false;
+        depth_ = 0;
+        basic_json_filter<Char>::begin_json();
+    }
+
+    virtual void begin_object(const basic_parsing_context<Char>& context)
+    {
+        if (begin_container(false))
+        {
+            basic_json_filter<Char>::begin_object(context);
+        }
+    }
+
+    virtual void end_object(const basic_parsing_context<Char>& context)
+    {
+        if (end_container())
+        {
+            basic_json_filter<Char>::end_object(context);
+        }
+    }
+
+    virtual void begin_array(const basic_parsing_context<Char>& context)
+    {
+        if (begin_container(true))
+        {
+            basic_json_filter<Char>::begin_array(context);
+        }
+    }
+
+    virtual void end_array(const basic_parsing_context<Char>& context)
+    {
+        if (end_container())
+        {
+            basic_json_filter<Char>::end_array(context);
+        }
+    }
+
+    virtual void name(const std::basic_string<Char>& name, const basic_parsing_context<Char>& context)
+    {
+        if (depth_ > 0)
+        {
+            return;
+        }
+        size_t n = stack_.back().node_;
+        next_ = nodes_[n].all_ ? n : member(n,name.data(),name.size());
+        drop_ = !nodes_[n].all_ && next_ == 0;
+        if (!drop_)
+        {
+            basic_json_filter<Char>::name(name,context);
+        }
+    }
+
+    virtual bool skip_value()
+    {
+        if (drop_)
+        {
+            // the reader moves past it, nothing of it comes here
+            drop_ = false;
+            return true;
+        }
+        return basic_json_filter<Char>::skip_value();
+    }
+
+    virtual void null_value(const basic_parsing_context<Char>& context)
+    {
+        if (keep_value())
+        {
+            basic_json_filter<Char>::null_value(context);
+        }
+    }
+
+    virtual void string_value(const std::basic_string<Char>& value, const basic_parsing_context<Char>& context)
+    {
+        if (keep_value())
+        {
+            basic_json_filter<Char>::string_value(value,context);
+        }
+    }
+
+    virtual void double_value(double value, const basic_parsing_context<Char>& context)
+    {
+        if (keep_value())
+        {
+            basic_json_filter<Char>::double_value(value,context);
+        }
+    }
+
+    virtual void longlong_value(long long value, const basic_parsing_context<Char>& context)
+    {
+        if (keep_value())
+        {
+            basic_json_filter<Char>::longlong_value(value,context);
+        }
+    }
+
+    virtual void ulonglong_value(unsigned long long value, const basic_parsing_context<Char>& context)
+    {
+        if (keep_value())
+        {
+            basic_json_filter<Char>::ulonglong_value(value,context);
+        }
+    }
+
+    virtual void bool_value(bool value, const basic_parsing_context<Char>& context)
+    {
+        if (keep_value())
+        {
+            basic_json_filter<Char>::bool_value(value,context);
+        }
+    }
+
+private:
+    // The child of node n with the name, 0 (the root, never a child) when
+    // there is none
+    size_t member(size_t n, const Char* name, size_t length) const
+    {
+        const std::vector<std::pair<std::basic_string<Char>,size_t>>& members = nodes_[n].members_;
+        for (size_t i = 0; i < members.size(); ++i)
+        {
+            if (members[i].first.size() == length && std::char_traits<Char>::compare(members[i].first.data(),name,length) == 0)
+            {
+                return members[i].second;
+            }
+        }
+        return 0;
+    }
+
+    bool keep_value()
+    {
+        if (depth_ > 0)
+        {
+            return false;
+        }
+        bool keep = !drop_;
+        drop_ = false;
+        return keep;
+    }
+
+    bool begin_container(bool array)
+    {
+        if (depth_ > 0 || drop_)
+        {
+            drop_ = false;
+            ++depth_;
+            return false;
+        }
+        // the elements of an array are under the name of the array
+        size_t n = stack_.empty() ? 0 : (stack_.back().array_ ? stack_.back().node_ : next_);
+        frame f = {n, array};
+        stack_.push_back(f);
+        return true;
+    }
+
+    bool end_container()
+    {
+        if (depth_ > 0)
+        {
+            --depth_;
+            return false;
+        }
+        stack_.pop_back();
+        return true;
+    }
+
+    std::vector<node> nodes_;
+    std::vector<frame> stack_;
+    size_t next_;  // the node of the value after the latest name
+    bool drop_;    // that value is not kept
+    size_t depth_; // inside a dropped value
+};
+
+typedef basic_json_projection<char> json_projection;
+typedef basic_json_projection<wchar_t> wjson_projection;
+
 }
 
 #endif
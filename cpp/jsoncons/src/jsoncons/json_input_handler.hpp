@@ -90,6 +90,14 @@ public:
 
     virtual void name(const std::basic_string<Char>& name, const basic_parsing_context<Char>& context) = 0;
 
+    // Asked by basic_json_reader right after name(): true when the value of
+    // that member is not wanted. The reader then moves past the value
+    // without reading it and reports nothing for it.
+    virtual bool skip_value()
+    {
+        return false;
+    }
+
 // value(...) implementation
 
     virtual void null_value(const basic_parsing_context<Char>& context) = 0;
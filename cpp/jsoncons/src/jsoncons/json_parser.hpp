@@ -0,0 +1,72 @@
+// Copyright 2013 Daniel Parker
+// Distributed under the Boost license, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+// See https://sourceforge.net/projects/jsoncons/files/ for latest version
+// See https://sourceforge.net/p/jsoncons/wiki/Home/ for documentation.
+
+#ifndef JSONCONS_JSON_PARSER_HPP
+#define JSONCONS_JSON_PARSER_HPP
+
+#include <string>
+#include "jsoncons/json1.hpp"
+#include "jsoncons/json_reader.hpp"
+#include "jsoncons/json_deserializer.hpp"
+#include "jsoncons/json_filter.hpp"
+
+namespace jsoncons {
+
+// Parses text after text with one reader and deserializer, so that their
+// buffers are set up once rather than for every text
+template <typename Char,class Storage>
+class basic_json_parser
+{
+public:
+    basic_json_parser()
+        : handler_(), projection_(handler_), reader_(handler_)
+    {
+    }
+
+    // Builds only the members on the paths, as basic_json_projection does,
+    // e.g. {{"msgType"},{"data","race","track"}}
+    basic_json_parser(std::initializer_list<std::initializer_list<const Char*>> paths)
+        : handler_(), projection_(handler_,paths), reader_(projection_)
+    {
+    }
+
+    // Replaces val, and releases what it held, only if the parse succeeds
+    void parse(const Char* s, size_t length, basic_json<Char,Storage>& val)
+    {
+        handler_.reset();
+        reader_.read(s,length);
+        handler_.root().swap(val);
+        handler_.reset();
+    }
+
+    void parse(const std::basic_string<Char>& s, basic_json<Char,Storage>& val)
+    {
+        parse(s.data(),s.length(),val);
+    }
+
+    basic_json<Char,Storage> parse(const Char* s, size_t length)
+    {
+        basic_json<Char,Storage> val;
+        parse(s,length,val);
+        return val;
+    }
+
+private:
+    basic_json_parser(const basic_json_parser&); // noop
+    basic_json_parser& operator = (const basic_json_parser&); // noop
+
+    basic_json_deserializer<Char,Storage> handler_;
+    basic_json_projection<Char> projection_;
+    basic_json_reader<Char> reader_;
+};
+
+typedef basic_json_parser<char,storage<char>> json_parser;
+typedef basic_json_parser<wchar_t,storage<wchar_t>> wjson_parser;
+
+}
+
+#endif
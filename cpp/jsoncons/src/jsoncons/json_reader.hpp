@@ -18,6 +18,7 @@
 #include "jsoncons/jsoncons.hpp"
 #include "jsoncons/json_input_handler.hpp"
 #include "jsoncons/error_handler.hpp"
+#include "jsoncons/json_scan.hpp"
 
 namespace jsoncons {
 
@@ -84,7 +85,11 @@ public:
          err_handler_(err_handler),
          bof_(true),
          eof_(false),
-         stream_ptr_(new buffered_stream(is))
+         stream_ptr_(new buffered_stream(is)),
+         input_(0),
+         range_(0),
+         range_length_(0),
+         range_tail_(false)
     {
     }
     basic_json_reader(std::basic_istream<Char>& is,
@@ -105,7 +110,60 @@ public:
          err_handler_(default_err_handler),
          bof_(true),
          eof_(false), 
-         stream_ptr_(new buffered_stream(is))
+         stream_ptr_(new buffered_stream(is)),
+         input_(0),
+         range_(0),
+         range_length_(0),
+         range_tail_(false)
+    {
+    }
+
+    //  For read(const Char*, size_t) only
+    basic_json_reader(basic_json_input_handler<Char>& handler,
+                      basic_error_handler<Char>& err_handler)
+       :
+         minimum_structure_capacity_(0),
+         column_(),
+         line_(),
+         string_buffer_(),
+         stack_(),
+         buffer_capacity_(default_max_buffer_length),
+         buffer_position_(0),
+         buffer_length_(0),
+         hard_buffer_length_(0),
+         estimation_buffer_length_(default_max_buffer_length),
+         handler_(handler),
+         err_handler_(err_handler),
+         bof_(true),
+         eof_(false),
+         stream_ptr_(),
+         input_(0),
+         range_(0),
+         range_length_(0),
+         range_tail_(false)
+    {
+    }
+    basic_json_reader(basic_json_input_handler<Char>& handler)
+       :
+         minimum_structure_capacity_(0),
+         column_(),
+         line_(),
+         string_buffer_(),
+         stack_(),
+         buffer_capacity_(default_max_buffer_length),
+         buffer_position_(0),
+         buffer_length_(0),
+         hard_buffer_length_(0),
+         estimation_buffer_length_(default_max_buffer_length),
+         handler_(handler),
+         err_handler_(default_err_handler),
+         bof_(true),
+         eof_(false),
+         stream_ptr_(),
+         input_(0),
+         range_(0),
+         range_length_(0),
+         range_tail_(false)
     {
     }
 
@@ -115,11 +173,20 @@ public:
 
     void read()
     {
+        if (!stream_ptr_)
+        {
+            JSONCONS_THROW_EXCEPTION("No input stream");
+        }
         read(stream_ptr_->is_);
     }
 
     void read(std::basic_istream<Char>& is);
 
+    //  Parse length characters in place. Only the last read_ahead_length
+    //  of them are copied, so that looking ahead stays in bounds. The reader
+    //  and its buffers can be reused for the next text.
+    void read(const Char* s, size_t length);
+
     bool eof() const
     {
         return eof_;
@@ -168,6 +235,18 @@ private:
     void parse_separator();
     void parse_number(Char c);
     void parse_string();
+    void pass_over_value();
+
+    void skip_blanks()
+    {
+        if (buffer_position_ >= buffer_length_)
+        {
+            return;
+        }
+        size_t count = json_scan<Char>::blank_run(input_ + buffer_position_, buffer_length_ - buffer_position_);
+        buffer_position_ += count;
+        column_ += count;
+    }
     void ignore_single_line_comment();
     void ignore_multi_line_comment();
     uint32_t decode_unicode_codepoint();
@@ -189,6 +268,12 @@ private:
         }
 
         buffer_position_ = 0;
+        if (range_ != 0)
+        {
+            read_some_range(extra);
+            return;
+        }
+        input_ = &buffer_[0];
         if (!stream_ptr_->is_.eof())
         {
             if (bof_)
@@ -243,9 +328,58 @@ private:
             hard_buffer_length_ = 0;
             eof_ = true;
         }
+    }
 
+    void read_some_range(size_t extra)
+    {
+        if (bof_)
+        {
+            bof_ = false;
+            if (range_length_ > read_ahead_length)
+            {
+                input_ = range_;
+                buffer_length_ = range_length_ - read_ahead_length;
+                hard_buffer_length_ = range_length_;
+                return;
+            }
+            // too short to look ahead in place
+            range_tail_ = true;
+            for (size_t i = 0; i < range_length_; ++i)
+            {
+                buffer_[i] = range_[i];
+            }
+            buffer_length_ = range_length_;
+        }
+        else if (!range_tail_)
+        {
+            // the unread part of the read ahead, then zeros
+            range_tail_ = true;
+            size_t unread = read_ahead_length - extra;
+            const Char* tail = input_ + buffer_length_ + extra;
+            for (size_t i = 0; i < unread; ++i)
+            {
+                buffer_[i] = tail[i];
+            }
+            buffer_length_ = unread;
+        }
+        else
+        {
+            buffer_length_ = 0;
+            hard_buffer_length_ = 0;
+            eof_ = true;
+            input_ = &buffer_[0];
+            return;
+        }
+        for (size_t i = 0; i < read_ahead_length; ++i)
+        {
+            buffer_[buffer_length_ + i] = 0;
+        }
+        hard_buffer_length_ = buffer_length_;
+        input_ = &buffer_[0];
     }
 
+    void read_all();
+
     size_t minimum_structure_capacity_;
     unsigned long column_;
     unsigned long line_;
@@ -262,6 +396,10 @@ private:
     bool bof_;
     bool eof_;
     std::unique_ptr<buffered_stream> stream_ptr_;
+    const Char* input_; // buffer_, or the text given to read(s, length)
+    const Char* range_;
+    size_t range_length_;
+    bool range_tail_;
 };
 
 template<typename Char>
@@ -300,8 +438,34 @@ void basic_json_reader<Char>::read(std::basic_istream<Char>& is)
     {
         JSONCONS_THROW_EXCEPTION("Input stream is invalid");
     }
-    stream_ptr_ = std::unique_ptr<buffered_stream>(new buffered_stream(is));
+    if (!stream_ptr_ || &stream_ptr_->is_ != &is)
+    {
+        stream_ptr_ = std::unique_ptr<buffered_stream>(new buffered_stream(is));
+    }
     buffer_.resize(buffer_capacity_ + 2*read_ahead_length);
+    input_ = &buffer_[0];
+    range_ = 0;
+    range_length_ = 0;
+    read_all();
+}
+
+template<typename Char>
+void basic_json_reader<Char>::read(const Char* s, size_t length)
+{
+    if (buffer_.size() < 2*read_ahead_length)
+    {
+        buffer_.resize(2*read_ahead_length);
+    }
+    input_ = &buffer_[0];
+    range_ = length > 0 ? s : &buffer_[0];
+    range_length_ = length;
+    range_tail_ = false;
+    read_all();
+}
+
+template<typename Char>
+void basic_json_reader<Char>::read_all()
+{
     buffer_position_ = 0;
     buffer_length_ = 0;
     hard_buffer_length_ = 0;
@@ -309,6 +473,7 @@ void basic_json_reader<Char>::read(std::basic_istream<Char>& is)
     eof_ = false;
     line_ = 1;
     column_ = 0;
+    stack_.clear();
 
     if (buffer_position_ >= buffer_length_)
     {
@@ -318,47 +483,34 @@ void basic_json_reader<Char>::read(std::basic_istream<Char>& is)
     {
         while (buffer_position_ < buffer_length_)
         {
-            Char c = buffer_[buffer_position_++];
+            Char c = input_[buffer_position_++];
             ++column_;
             switch (c)
             {
             case '\r':
                 ++line_;
                 column_ = 0;
-                if (buffer_[buffer_position_] == '\n')
+                if (input_[buffer_position_] == '\n')
                 {
                     ++buffer_position_;
                 }
+                skip_blanks();
                 break;
             case '\n':
                 ++line_;
                 column_ = 0;
+                // the indent of the next line
+                skip_blanks();
                 break;
             case '\t':
             case '\v':
             case '\f':
             case ' ':
-                {
-                    size_t count = 0;
-                    if (buffer_[buffer_position_] == ' ')
-                    {
-                        ++count;
-                    }
-                    if ((buffer_[buffer_position_] == ' ') & (buffer_[buffer_position_+1] == ' '))
-                    {
-                        ++count;
-                    }
-                    if ((buffer_[buffer_position_] == ' ') & (buffer_[buffer_position_+1] == ' ') & (buffer_[buffer_position_+2] == ' '))
-                    {
-                        ++count;
-                    }
-                    buffer_position_ += count;
-                    column_ += count;
-                }
+                skip_blanks();
                 break;
             case '/':
                 {
-                    Char next = buffer_[buffer_position_];
+                    Char next = input_[buffer_position_];
                     if (next == '/')
                     {
                         ++buffer_position_;
@@ -417,11 +569,11 @@ void basic_json_reader<Char>::read(std::basic_istream<Char>& is)
                             {
                                 handler_.name(string_buffer_, *this);
                                 count1 = 0;
-                                if (buffer_[buffer_position_] == ':')
+                                if (input_[buffer_position_] == ':')
                                 {
                                     ++count1;
                                 }
-                                if ((buffer_[buffer_position_] == ' ') & (buffer_[buffer_position_+1] == ':'))
+                                if ((input_[buffer_position_] == ' ') & (input_[buffer_position_+1] == ':'))
                                 {
                                     count1 += 2;
                                 }
@@ -433,6 +585,12 @@ void basic_json_reader<Char>::read(std::basic_istream<Char>& is)
                                     parse_separator();
                                 }
                                 ++stack_.back().name_count_;
+                                if (handler_.skip_value())
+                                {
+                                    pass_over_value();
+                                    stack_.back().comma_ = false;
+                                    ++stack_.back().value_count_;
+                                }
                             }
                             else
                             {
@@ -495,7 +653,7 @@ void basic_json_reader<Char>::read(std::basic_istream<Char>& is)
                         }
                         break;
                     case 't':
-                        if (!((buffer_[buffer_position_] == 'r') & (buffer_[buffer_position_ + 1] == 'u') & (buffer_[buffer_position_ + 2] == 'e')))
+                        if (!((input_[buffer_position_] == 'r') & (input_[buffer_position_ + 1] == 'u') & (input_[buffer_position_ + 2] == 'e')))
                         {
                             err_handler_.fatal_error("JPE105", "Unrecognized value", *this);
                         }
@@ -506,7 +664,7 @@ void basic_json_reader<Char>::read(std::basic_istream<Char>& is)
                         ++stack_.back().value_count_;
                         break;
                     case 'f':
-                        if (!((buffer_[buffer_position_] == 'a') & (buffer_[buffer_position_ + 1] == 'l') & (buffer_[buffer_position_ + 2] == 's') & (buffer_[buffer_position_ + 3] == 'e')))
+                        if (!((input_[buffer_position_] == 'a') & (input_[buffer_position_ + 1] == 'l') & (input_[buffer_position_ + 2] == 's') & (input_[buffer_position_ + 3] == 'e')))
                         {
                             err_handler_.fatal_error("JPE105", "Unrecognized value", *this);
                         }
@@ -517,7 +675,7 @@ void basic_json_reader<Char>::read(std::basic_istream<Char>& is)
                         ++stack_.back().value_count_;
                         break;
                     case 'n':
-                        if (!((buffer_[buffer_position_] == 'u') & (buffer_[buffer_position_ + 1] == 'l') & (buffer_[buffer_position_ + 2] == 'l')))
+                        if (!((input_[buffer_position_] == 'u') & (input_[buffer_position_ + 1] == 'l') & (input_[buffer_position_ + 2] == 'l')))
                         {
                             err_handler_.fatal_error("JPE105", "Unrecognized value", *this);
                         }
@@ -571,12 +729,12 @@ void basic_json_reader<Char>::parse_separator()
         const size_t end = buffer_length_;
         while (!done & (buffer_position_ < end))
         {
-            Char c = buffer_[buffer_position_++];
+            Char c = input_[buffer_position_++];
             ++column_;
             switch (c)
             {
             case '\r':
-                if (buffer_[buffer_position_] == '\n')
+                if (input_[buffer_position_] == '\n')
                 {
                     ++buffer_position_;
                 }
@@ -594,7 +752,7 @@ void basic_json_reader<Char>::parse_separator()
                 break;
             case '/':
                 {
-                    Char next = buffer_[buffer_position_];
+                    Char next = input_[buffer_position_];
                     if (next == '/')
                     {
                         ignore_single_line_comment();
@@ -640,7 +798,7 @@ void basic_json_reader<Char>::parse_number(Char c)
         const size_t end = buffer_length_;
         while (!done & (buffer_position_ < end))
         {
-            Char c = buffer_[buffer_position_++]; // shouldn't be lf
+            Char c = input_[buffer_position_++]; // shouldn't be lf
             ++column_;
             switch (c)
             {
@@ -751,7 +909,20 @@ void basic_json_reader<Char>::parse_string()
         const size_t end = buffer_length_;
         while (!done & (buffer_position_ < end))
         {
-            Char c = buffer_[buffer_position_++];
+            // the plain characters up to the next quote, backslash or
+            // control character in one append
+            size_t run = json_scan<Char>::string_run(input_ + buffer_position_, end - buffer_position_);
+            if (run > 0)
+            {
+                string_buffer_.append(input_ + buffer_position_, run);
+                buffer_position_ += run;
+                column_ += run;
+                if (buffer_position_ == end)
+                {
+                    break;
+                }
+            }
+            Char c = input_[buffer_position_++];
             ++column_;
             switch (c)
             {
@@ -791,7 +962,7 @@ void basic_json_reader<Char>::parse_string()
                 break;
             case '\\':
                 {
-                    Char next = buffer_[buffer_position_];
+                    Char next = input_[buffer_position_];
                     switch (next)
                     {
                     case '\"':
@@ -857,6 +1028,117 @@ void basic_json_reader<Char>::parse_string()
     }
 }
 
+// Moves past the value of a member that the handler has no use for. Its
+// strings are not unescaped and its numbers are not converted; the value is
+// only checked to be balanced.
+template<typename Char>
+void basic_json_reader<Char>::pass_over_value()
+{
+    size_t depth = 0;
+    bool started = false;
+    bool in_string = false;
+    bool done = false;
+    while (!done)
+    {
+        const size_t end = buffer_length_;
+        while (!done & (buffer_position_ < end))
+        {
+            if (in_string)
+            {
+                size_t run = json_scan<Char>::string_run(input_ + buffer_position_, end - buffer_position_);
+                buffer_position_ += run;
+                column_ += run;
+                if (buffer_position_ == end)
+                {
+                    break;
+                }
+                Char c = input_[buffer_position_++];
+                ++column_;
+                if (c == '\\')
+                {
+                    ++buffer_position_;
+                    ++column_;
+                }
+                else if (c == '\"')
+                {
+                    in_string = false;
+                    done = depth == 0;
+                }
+                continue;
+            }
+            Char c = input_[buffer_position_];
+            switch (c)
+            {
+            case '\r':
+            case '\n':
+            case '\t':
+            case '\v':
+            case '\f':
+            case ' ':
+                if (started & (depth == 0))
+                {
+                    done = true;
+                    break;
+                }
+                ++buffer_position_;
+                ++column_;
+                if (c == '\n')
+                {
+                    ++line_;
+                    column_ = 0;
+                }
+                break;
+            case value_separator:
+            case end_object:
+            case end_array:
+                if (depth == 0)
+                {
+                    if (!started)
+                    {
+                        err_handler_.fatal_error("JPE107", "Value not found", *this);
+                    }
+                    done = true;
+                    break;
+                }
+                ++buffer_position_;
+                ++column_;
+                if (c != value_separator)
+                {
+                    --depth;
+                    done = depth == 0;
+                }
+                break;
+            case begin_object:
+            case begin_array:
+                ++buffer_position_;
+                ++column_;
+                ++depth;
+                started = true;
+                break;
+            case '\"':
+                ++buffer_position_;
+                ++column_;
+                in_string = true;
+                started = true;
+                break;
+            default:
+                ++buffer_position_;
+                ++column_;
+                started = true;
+                break;
+            }
+        }
+        if (!done)
+        {
+            read_some();
+            if (eof())
+            {
+                err_handler_.fatal_error("JPE101", "Unexpected EOF", *this);
+            }
+        }
+    }
+}
+
 template<typename Char>
 void basic_json_reader<Char>::ignore_single_line_comment()
 {
@@ -866,12 +1148,12 @@ void basic_json_reader<Char>::ignore_single_line_comment()
         const size_t end = buffer_length_;
         while (!done & (buffer_position_ < end))
         {
-            Char c = buffer_[buffer_position_++];
+            Char c = input_[buffer_position_++];
             ++column_;
             switch (c)
             {
             case '\r':
-                if (buffer_[buffer_position_] == '\n')
+                if (input_[buffer_position_] == '\n')
                 {
                     ++buffer_position_;
                 }
@@ -906,12 +1188,12 @@ void basic_json_reader<Char>::ignore_multi_line_comment()
         const size_t end = buffer_length_;
         while (!done & (buffer_position_ < end))
         {
-            Char c = buffer_[buffer_position_++];
+            Char c = input_[buffer_position_++];
             ++column_;
             switch (c)
             {
             case '\r':
-                if (buffer_[buffer_position_] == '\n')
+                if (input_[buffer_position_] == '\n')
                 {
                     ++buffer_position_;
                 }
@@ -924,7 +1206,7 @@ void basic_json_reader<Char>::ignore_multi_line_comment()
                 break;
             case '*':
                 {
-                    Char next = buffer_[buffer_position_];
+                    Char next = input_[buffer_position_];
                     if (next == '/')
                     {
                         done = true;
@@ -955,7 +1237,7 @@ size_t basic_json_reader<Char>::estimate_minimum_array_capacity() const
     const size_t end = std::min JSONCONS_NO_MACRO_EXP(buffer_length_,estimation_buffer_length_);
     while (!done & (pos < end))
     {
-        switch (buffer_[pos])
+        switch (input_[pos])
         {
         case end_array:
             done = true;
@@ -1016,7 +1298,7 @@ size_t basic_json_reader<Char>::estimate_minimum_object_capacity() const
     const size_t end = std::min JSONCONS_NO_MACRO_EXP(buffer_length_,estimation_buffer_length_);
     while (!done & (pos < end))
     {
-        switch (buffer_[pos])
+        switch (input_[pos])
         {
         case end_object:
             done = true;
@@ -1058,7 +1340,7 @@ size_t basic_json_reader<Char>::skip_array(size_t pos, const size_t end) const
     bool done = false;
     while (!done & (pos < end))
     {
-        switch (buffer_[pos])
+        switch (input_[pos])
         {
         case begin_array:
             pos = skip_array(pos + 1, end);
@@ -1088,11 +1370,11 @@ size_t basic_json_reader<Char>::skip_string(size_t pos, const size_t end) const
     bool done = false;
     while (!done & (pos < end))
     {
-        switch (buffer_[pos])
+        switch (input_[pos])
         {
         case '\\':
             ++pos;
-            if ((pos < buffer_length_) & (buffer_[pos] == 'u'))
+            if ((pos < buffer_length_) & (input_[pos] == 'u'))
             {
                 pos += 4;
             }
@@ -1120,7 +1402,7 @@ size_t basic_json_reader<Char>::skip_number(size_t pos, const size_t end) const
     bool done = false;
     while (!done & (pos < end))
     {
-        switch (buffer_[pos])
+        switch (input_[pos])
         {
         case '0':
         case '1':
@@ -1154,7 +1436,7 @@ size_t basic_json_reader<Char>::skip_object(size_t pos, const size_t end) const
     bool done = false;
     while (!done & (pos < end))
     {
-        switch (buffer_[pos])
+        switch (input_[pos])
         {
         case begin_object:
             pos = skip_object(pos + 1, end);
@@ -1189,7 +1471,7 @@ uint32_t basic_json_reader<Char>::decode_unicode_codepoint()
     if (cp >= min_lead_surrogate && cp <= max_lead_surrogate)
     {
         // surrogate pair
-        if (buffer_[buffer_position_++] == '\\' && buffer_[buffer_position_++] == 'u')
+        if (input_[buffer_position_++] == '\\' && input_[buffer_position_++] == 'u')
         {
             column_ += 2;
             uint32_t surrogate_pair = decode_unicode_escape_sequence();
@@ -1215,7 +1497,7 @@ uint32_t basic_json_reader<Char>::decode_unicode_escape_sequence()
     size_t index = 0;
     while (index < 4)
     {
-        Char c = buffer_[buffer_position_++];
+        Char c = input_[buffer_position_++];
         ++column_;
         const uint32_t u(c >= 0 ? c : 256 + c);
         cp *= 16;
@@ -0,0 +1,180 @@
+// Copyright 2013 Daniel Parker
+// Distributed under the Boost license, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+// See https://sourceforge.net/projects/jsoncons/files/ for latest version
+// See https://sourceforge.net/p/jsoncons/wiki/Home/ for documentation.
+
+#ifndef JSONCONS_JSON_SCAN_HPP
+#define JSONCONS_JSON_SCAN_HPP
+
+#include <cstddef>
+
+// The reader skips blanks and copies plain string runs a vector at a time
+// where the target has SSE2 (every x86-64) or AVX2 (e.g. -mavx2 or
+// -march=native). Define JSONCONS_NO_SIMD for the scalar loops everywhere.
+#if !defined(JSONCONS_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define JSONCONS_HAS_SSE2
+#include <emmintrin.h>
+#if defined(__AVX2__)
+#define JSONCONS_HAS_AVX2
+#include <immintrin.h>
+#endif
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+namespace jsoncons {
+
+// Both scans return how many characters from the start of [p, p+n) belong
+// to the run; they never read past p+n.
+template <typename Char>
+struct json_scan
+{
+    // Characters a string copies as they are: anything but the quote,
+    // the backslash and the control characters
+    static size_t string_run(const Char* p, size_t n)
+    {
+        size_t i = 0;
+        while (i < n && is_plain(p[i]))
+        {
+            ++i;
+        }
+        return i;
+    }
+
+    // Spaces and tabs; line ends are left to the caller, which counts lines
+    static size_t blank_run(const Char* p, size_t n)
+    {
+        size_t i = 0;
+        while (i < n && ((p[i] == ' ') | (p[i] == '\t')))
+        {
+            ++i;
+        }
+        return i;
+    }
+
+    static bool is_plain(Char c)
+    {
+        return (c != '\"') & (c != '\\') & !((c >= 0) & (c < 0x20));
+    }
+};
+
+#ifdef JSONCONS_HAS_SSE2
+
+inline unsigned json_scan_first_bit(unsigned mask)
+{
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return index;
+#else
+    return __builtin_ctz(mask);
+#endif
+}
+
+template <>
+struct json_scan<char>
+{
+    static size_t string_run(const char* p, size_t n)
+    {
+        size_t i = 0;
+#ifdef JSONCONS_HAS_AVX2
+        {
+            const __m256i quote = _mm256_set1_epi8('\"');
+            const __m256i backslash = _mm256_set1_epi8('\\');
+            const __m256i control = _mm256_set1_epi8(0x1f);
+            for (; i + 32 <= n; i += 32)
+            {
+                __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i));
+                // x <= 0x1f unsigned is max(x, 0x1f) == 0x1f
+                __m256i special = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(x, quote), _mm256_cmpeq_epi8(x, backslash)),
+                                                  _mm256_cmpeq_epi8(_mm256_max_epu8(x, control), control));
+                unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(special));
+                if (mask != 0)
+                {
+                    return i + json_scan_first_bit(mask);
+                }
+            }
+        }
+#endif
+        const __m128i quote = _mm_set1_epi8('\"');
+        const __m128i backslash = _mm_set1_epi8('\\');
+        const __m128i control = _mm_set1_epi8(0x1f);
+        for (; i + 16 <= n; i += 16)
+        {
+            __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+            __m128i special = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(x, quote), _mm_cmpeq_epi8(x, backslash)),
+                                           _mm_cmpeq_epi8(_mm_max_epu8(x, control), control));
+            unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(special));
+            if (mask != 0)
+            {
+                return i + json_scan_first_bit(mask);
+            }
+        }
+        while (i < n && is_plain(p[i]))
+        {
+            ++i;
+        }
+        return i;
+    }
+
+    static size_t blank_run(const char* p, size_t n)
+    {
+        size_t i = 0;
+        // most runs are a single space or the indent of a line, so a few
+        // characters are looked at one by one before the vectors
+        for (size_t k = 0; k < 4; ++k, ++i)
+        {
+            if (i == n || ((p[i] != ' ') & (p[i] != '\t')))
+            {
+                return i;
+            }
+        }
+#ifdef JSONCONS_HAS_AVX2
+        {
+            const __m256i space = _mm256_set1_epi8(' ');
+            const __m256i tab = _mm256_set1_epi8('\t');
+            for (; i + 32 <= n; i += 32)
+            {
+                __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i));
+                __m256i blank = _mm256_or_si256(_mm256_cmpeq_epi8(x, space), _mm256_cmpeq_epi8(x, tab));
+                unsigned mask = ~static_cast<unsigned>(_mm256_movemask_epi8(blank));
+                if (mask != 0)
+                {
+                    return i + json_scan_first_bit(mask);
+                }
+            }
+        }
+#endif
+        const __m128i space = _mm_set1_epi8(' ');
+        const __m128i tab = _mm_set1_epi8('\t');
+        for (; i + 16 <= n; i += 16)
+        {
+            __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+            __m128i blank = _mm_or_si128(_mm_cmpeq_epi8(x, space), _mm_cmpeq_epi8(x, tab));
+            unsigned mask = ~static_cast<unsigned>(_mm_movemask_epi8(blank)) & 0xffff;
+            if (mask != 0)
+            {
+                return i + json_scan_first_bit(mask);
+            }
+        }
+        while (i < n && ((p[i] == ' ') | (p[i] == '\t')))
+        {
+            ++i;
+        }
+        return i;
+    }
+
+    static bool is_plain(char c)
+    {
+        return (c != '\"') & (c != '\\') & (static_cast<unsigned char>(c) >= 0x20);
+    }
+};
+
+#endif
+
+}
+
+#endif
@@ -182,8 +182,16 @@ public:
         }
         else
         {
-            std::basic_string<Char> buf = double_to_string<Char>(value,format_.precision());
-            os_ << buf;
+            Char buf[double_buffer_size];
+            size_t length = format_double(buf,value,format_.precision());
+            if (length > 0)
+            {
+                os_.write(buf,length);
+            }
+            else
+            {
+                os_ << double_to_string<Char>(value,format_.precision());
+            }
         }
 
         end_value();
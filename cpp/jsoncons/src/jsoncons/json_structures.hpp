@@ -45,12 +45,34 @@ public:
     }
 };
 
+// The member named key in sorted members, or last. A name from the key
+// table is the same string as the names of all the members equal to it,
+// so in a small object the members are scanned comparing pointers.
+template <typename Char,class Storage,class Iterator>
+Iterator find_member(Iterator first, Iterator last, const basic_json_key<Char>& key)
+{
+    if (key.interned() && last - first <= 16)
+    {
+        for (Iterator it = first; it != last; ++it)
+        {
+            if (it->key() == key)
+            {
+                return it;
+            }
+        }
+        return last;
+    }
+    Iterator it = std::lower_bound(first,last,key.str(),key_compare<Char,Storage>());
+    return (it != last && it->key() == key) ? it : last;
+}
+
 template <typename Char,class Storage>
 class json_array 
 {
 public:
-    typedef typename std::vector<basic_json<Char,Storage>>::iterator iterator;
-    typedef typename std::vector<basic_json<Char,Storage>>::const_iterator const_iterator;
+    typedef std::vector<basic_json<Char,Storage>,typename Storage::template allocator<basic_json<Char,Storage>>> elements_type;
+    typedef typename elements_type::iterator iterator;
+    typedef typename elements_type::const_iterator const_iterator;
 
     json_array()
     {
@@ -66,7 +88,7 @@ public:
     {
     }
 
-    json_array(std::vector<basic_json<Char,Storage>> elements)
+    json_array(const elements_type& elements)
         : elements_(elements)
     {
     }
@@ -79,7 +101,7 @@ public:
 
     json_array<Char,Storage>* clone() 
     {
-        return new json_array(elements_);
+        return create_instance<Storage,json_array>(elements_);
     }
 
     size_t size() const {return elements_.size();}
@@ -118,13 +140,13 @@ public:
 
     void push_back(basic_json<Char,Storage>&& value)
     {
-        elements_.push_back(value);
+        elements_.push_back(std::move(value));
     }
 
     void add(size_t index, basic_json<Char,Storage>&& value)
     {
         json_array<Char,Storage>::iterator position = index < elements_.size() ? elements_.begin() + index : elements_.end();
-        elements_.insert(position, value);
+        elements_.insert(position, std::move(value));
     }
 
     iterator begin() {return elements_.begin();}
@@ -151,7 +173,7 @@ public:
         return true;
     }
 private:
-    std::vector<basic_json<Char,Storage>> elements_;
+    elements_type elements_;
     json_array(const json_array<Char,Storage>&);
     json_array& operator=(const json_array<Char,Storage>&);
 };
@@ -160,8 +182,9 @@ template <typename Char,class Storage>
 class json_object
 {
 public:
-    typedef typename std::vector<typename basic_json<Char,Storage>::member_type>::iterator iterator;
-    typedef typename std::vector<typename basic_json<Char,Storage>::member_type>::const_iterator const_iterator;
+    typedef std::vector<typename basic_json<Char,Storage>::member_type,typename Storage::template allocator<typename basic_json<Char,Storage>::member_type>> members_type;
+    typedef typename members_type::iterator iterator;
+    typedef typename members_type::const_iterator const_iterator;
 
     json_object()
     {
@@ -172,14 +195,14 @@ public:
     {
     }
 
-    json_object(std::vector<typename basic_json<Char,Storage>::member_type> members)
+    json_object(const members_type& members)
         : members_(members)
     {
     }
 
     json_object<Char,Storage>* clone() 
     {
-        return new json_object(members_);
+        return create_instance<Storage,json_object>(members_);
     }
 
     size_t size() const {return members_.size();}
@@ -239,11 +262,18 @@ public:
     void push_back(std::basic_string<Char>&& name, basic_json<Char,Storage>&& val)
     {
         members_.push_back(typename basic_json<Char,Storage>::member_type());
-        members_.back().name_.swap(name);
+        members_.back().name_ = basic_json_key<Char>(name);
         members_.back().value_.swap(val);
         //members_.push_back(typename basic_json<Char,Storage>::member_type(name,val)); // much slower on VS 2010
     }
 
+    void push_back(basic_json_key<Char>&& key, basic_json<Char,Storage>&& val)
+    {
+        members_.push_back(typename basic_json<Char,Storage>::member_type());
+        members_.back().name_.swap(key);
+        members_.back().value_.swap(val);
+    }
+
     iterator remove(iterator at); 
 
     basic_json<Char,Storage>& get(const std::basic_string<Char>& name);
@@ -254,6 +284,16 @@ public:
 
     const_iterator find(const std::basic_string<Char>& name) const;
 
+    iterator find(const basic_json_key<Char>& key)
+    {
+        return find_member<Char,Storage>(begin(),end(),key);
+    }
+
+    const_iterator find(const basic_json_key<Char>& key) const
+    {
+        return find_member<Char,Storage>(begin(),end(),key);
+    }
+
     void insert(iterator it, typename basic_json<Char,Storage>::member_type member);
 
     void sort_members();
@@ -284,7 +324,7 @@ public:
     }
 
 private:
-    std::vector<typename basic_json<Char,Storage>::member_type> members_;
+    members_type members_;
     json_object(const json_object<Char,Storage>&);
     json_object<Char,Storage>& operator=(const json_object<Char,Storage>&);
 };
@@ -358,7 +398,7 @@ typename json_object<Char,Storage>::const_iterator json_object<Char,Storage>::fi
 {
     key_compare<Char,Storage> comp;
     const_iterator it = std::lower_bound(begin(),end(),name, comp);
-    return (it != end() && it->name_ == name) ? it : end();
+    return (it != end() && it->name() == name) ? it : end();
 }
 
 }
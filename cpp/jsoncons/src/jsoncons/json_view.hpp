@@ -0,0 +1,296 @@
+// Copyright 2013 Daniel Parker
+// Distributed under the Boost license, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+// See https://sourceforge.net/projects/jsoncons/files/ for latest version
+// See https://sourceforge.net/p/jsoncons/wiki/Home/ for documentation.
+
+#ifndef JSONCONS_JSON_VIEW_HPP
+#define JSONCONS_JSON_VIEW_HPP
+
+#include <string>
+#include <algorithm>
+#include <iterator>
+#include <cstddef>
+#include "jsoncons/json1.hpp"
+
+namespace jsoncons {
+
+// A read only reference to a value inside a document, as cheap to copy as
+// a pointer. Member names are looked up as they are written, against the
+// sorted members in place, so no string and no default value is made on
+// the way; as<T>() goes through the same value_adapters as basic_json. The
+// document must outlive its views.
+template <typename Char,class Storage>
+class basic_json_view
+{
+public:
+    typedef basic_json<Char,Storage> json_type;
+    typedef typename json_type::const_object_iterator const_object_iterator;
+    typedef typename json_type::const_array_iterator const_array_iterator;
+
+    // The elements of an array, each as a view
+    class const_iterator
+    {
+    public:
+        typedef std::forward_iterator_tag iterator_category;
+        typedef basic_json_view value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef const basic_json_view* pointer;
+        typedef basic_json_view reference;
+
+        const_iterator()
+        {
+        }
+        explicit const_iterator(const_array_iterator it)
+            : it_(it)
+        {
+        }
+        basic_json_view operator*() const
+        {
+            return basic_json_view(*it_);
+        }
+        const_iterator& operator++()
+        {
+            ++it_;
+            return *this;
+        }
+        const_iterator operator++(int)
+        {
+            const_iterator old(*this);
+            ++it_;
+            return old;
+        }
+        bool operator==(const const_iterator& other) const
+        {
+            return it_ == other.it_;
+        }
+        bool operator!=(const const_iterator& other) const
+        {
+            return it_ != other.it_;
+        }
+    private:
+        const_array_iterator it_;
+    };
+
+    basic_json_view()
+        : val_(&json_type::null)
+    {
+    }
+
+    basic_json_view(const json_type& val)
+        : val_(&val)
+    {
+    }
+
+    const json_type& json() const
+    {
+        return *val_;
+    }
+
+    // The member called name; throws when there is none
+    basic_json_view operator[](const Char* name) const
+    {
+        return at(name);
+    }
+
+    basic_json_view operator[](const std::basic_string<Char>& name) const
+    {
+        return at(name);
+    }
+
+    basic_json_view operator[](size_t i) const
+    {
+        return basic_json_view((*val_)[i]);
+    }
+
+    basic_json_view at(const Char* name) const
+    {
+        return at(name,std::char_traits<Char>::length(name));
+    }
+
+    basic_json_view at(const std::basic_string<Char>& name) const
+    {
+        return at(name.data(),name.size());
+    }
+
+    // The member called name, or null when there is none
+    basic_json_view get(const Char* name) const
+    {
+        const json_type* val = find(name,std::char_traits<Char>::length(name));
+        return val != 0 ? basic_json_view(*val) : basic_json_view();
+    }
+
+    // The member called name as a T, or default_val when there is none
+    template <class T>
+    T get(const Char* name, const T& default_val) const
+    {
+        const json_type* val = find(name,std::char_traits<Char>::length(name));
+        return val != 0 ? val->template as<T>() : default_val;
+    }
+
+    bool has_member(const Char* name) const
+    {
+        return val_->is_object() && find(name,std::char_traits<Char>::length(name)) != 0;
+    }
+
+    size_t size() const
+    {
+        return val_->size();
+    }
+
+    const_iterator begin() const
+    {
+        return const_iterator(val_->begin_elements());
+    }
+
+    const_iterator end() const
+    {
+        return const_iterator(val_->end_elements());
+    }
+
+    const_object_iterator begin_members() const
+    {
+        return val_->begin_members();
+    }
+
+    const_object_iterator end_members() const
+    {
+        return val_->end_members();
+    }
+
+    template <class T>
+    bool is() const
+    {
+        return val_->template is<T>();
+    }
+
+    template <class T>
+    T as() const
+    {
+        return val_->template as<T>();
+    }
+
+    bool is_null() const
+    {
+        return val_->is_null();
+    }
+
+    bool is_object() const
+    {
+        return val_->is_object();
+    }
+
+    bool is_array() const
+    {
+        return val_->is_array();
+    }
+
+    bool is_string() const
+    {
+        return val_->is_string();
+    }
+
+    bool is_number() const
+    {
+        return val_->is_number();
+    }
+
+    bool is_bool() const
+    {
+        return val_->is_bool();
+    }
+
+    std::basic_string<Char> as_string() const
+    {
+        return val_->as_string();
+    }
+
+    double as_double() const
+    {
+        return val_->as_double();
+    }
+
+    int as_int() const
+    {
+        return val_->as_int();
+    }
+
+    bool as_bool() const
+    {
+        return val_->as_bool();
+    }
+
+    std::basic_string<Char> to_string() const
+    {
+        return val_->to_string();
+    }
+
+    friend std::basic_ostream<Char>& operator<<(std::basic_ostream<Char>& os, const basic_json_view& view)
+    {
+        view.val_->to_stream(os);
+        return os;
+    }
+
+private:
+    basic_json_view at(const Char* name, size_t length) const
+    {
+        const json_type* val = find(name,length);
+        if (val == 0)
+        {
+            JSONCONS_THROW_EXCEPTION_1("Member %s not found.",std::basic_string<Char>(name,length));
+        }
+        return basic_json_view(*val);
+    }
+
+    const json_type* find(const Char* name, size_t length) const
+    {
+        if (!val_->is_object())
+        {
+            JSONCONS_THROW_EXCEPTION_1("Attempting to get %s from a value that is not an object",std::basic_string<Char>(name,length));
+        }
+        const_object_iterator first = val_->begin_members();
+        const_object_iterator last = val_->end_members();
+        const_object_iterator it = std::lower_bound(first,last,name,
+            [length](const typename json_type::member_type& a, const Char* b)
+            {
+                return a.name().compare(0,a.name().size(),b,length) < 0;
+            });
+        if (it == last || it->name().compare(0,it->name().size(),name,length) != 0)
+        {
+            return 0;
+        }
+        return &it->value();
+    }
+
+    const json_type* val_;
+};
+
+// as<basic_json_view>() and as<std::vector<basic_json_view>>() give views
+// of a value and of the elements of an array
+template <typename Char,class Storage>
+class value_adapter<Char,Storage,basic_json_view<Char,Storage>>
+{
+public:
+    bool is(const basic_json<Char,Storage>&) const
+    {
+        return true;
+    }
+    basic_json_view<Char,Storage> as(const basic_json<Char,Storage>& val) const
+    {
+        return basic_json_view<Char,Storage>(val);
+    }
+};
+
+template <typename Char,class Storage>
+basic_json_view<Char,Storage> view_of(const basic_json<Char,Storage>& val)
+{
+    return basic_json_view<Char,Storage>(val);
+}
+
+typedef basic_json_view<char,storage<char>> json_view;
+typedef basic_json_view<wchar_t,storage<wchar_t>> wjson_view;
+
+}
+
+#endif
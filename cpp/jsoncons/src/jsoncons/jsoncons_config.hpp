@@ -19,6 +19,8 @@
 #include <cmath>
 #include <cstdarg>
 #include <limits> // std::numeric_limits
+#include <clocale>
+#include "jsoncons/number_conversion.hpp"
 
 #define JSONCONS_NO_MACRO_EXP 
 
@@ -102,6 +104,10 @@ std::basic_string<Char> double_to_string(double val, size_t precision)
     int decimal_point = 0;
     int sign = 0;
 
+    if (precision == 0)
+    {
+        precision = 17; // always reads back as val
+    }
     if (precision >= _CVTBUFSIZE)
     {
         precision = _CVTBUFSIZE - 1;
@@ -172,7 +178,7 @@ std::basic_string<Char> double_to_string(double val, size_t precision)
 }
 #else
 template <typename Char>
-std::basic_string<Char> double_to_string(double val, size_t precision)
+std::basic_string<Char> stream_double_to_string(double val, size_t precision)
 {
     std::basic_ostringstream<Char> os;
     os.imbue(std::locale::classic());
@@ -200,17 +206,47 @@ std::basic_string<Char> double_to_string(double val, size_t precision)
 
     return s;
 }
+
+template <typename Char>
+std::basic_string<Char> double_to_string(double val, size_t precision)
+{
+    Char buf[double_buffer_size];
+    size_t length = format_double(buf,val,precision);
+    if (length > 0)
+    {
+        return std::basic_string<Char>(buf,length);
+    }
+    if (precision != 0)
+    {
+        return stream_double_to_string<Char>(val,precision);
+    }
+    // the shortest of 15, 16 and 17 digits that reads back as val
+    for (size_t digits = 15; ; ++digits)
+    {
+        std::basic_string<Char> s = stream_double_to_string<Char>(val,digits);
+        double back;
+        if (digits == 17 || (decimal_to_double(s.data(),s.size(),back) && back == val))
+        {
+            return s;
+        }
+    }
+}
 #endif
 
 #ifdef _MSC_VER
 inline
 double string_to_double(const std::string& s)
 {
+    double val;
+    if (decimal_to_double(s.data(),s.size(),val))
+    {
+        return val;
+    }
     static _locale_t locale = _create_locale(LC_NUMERIC, "C");
 
     const char* begin = &s[0];
     char* end = const_cast<char*>(begin)+s.size();
-    double val = _strtod_l(begin,&end,locale);
+    val = _strtod_l(begin,&end,locale);
     if (begin == end)
     {
         throw std::invalid_argument("Invalid double value");
@@ -220,24 +256,74 @@ double string_to_double(const std::string& s)
 inline
 double string_to_double(const std::wstring& s)
 {
+    double val;
+    if (decimal_to_double(s.data(),s.size(),val))
+    {
+        return val;
+    }
     static _locale_t locale = _create_locale(LC_NUMERIC, "C");
 
     const wchar_t* begin = &s[0];
     wchar_t* end = const_cast<wchar_t*>(begin)+s.size();
-    double val = _wcstod_l(begin,&end,locale);
+    val = _wcstod_l(begin,&end,locale);
+    if (begin == end)
+    {
+        throw std::invalid_argument("Invalid double value");
+    }
+    return val;
+}
+#elif defined(__GLIBC__)
+inline
+double string_to_double(const std::string& s)
+{
+    double val;
+    if (decimal_to_double(s.data(),s.size(),val))
+    {
+        return val;
+    }
+
+    // strtod_l parses in place, a stringstream would allocate per number
+    static locale_t locale = newlocale(LC_NUMERIC_MASK, "C", (locale_t)0);
+
+    const char* begin = s.c_str();
+    char* end;
+    val = strtod_l(begin,&end,locale);
     if (begin == end)
     {
         throw std::invalid_argument("Invalid double value");
     }
     return val;
 }
-#else
 template <typename Char> inline
 double string_to_double(const std::basic_string<Char>& s)
 {
+    double val;
+    if (decimal_to_double(s.data(),s.size(),val))
+    {
+        return val;
+    }
+
     std::basic_stringstream<Char> ss(s);
     ss.imbue(std::locale::classic());
+    ss >> val;
+    if (ss.fail())
+    {
+        throw std::invalid_argument("Invalid double value");
+    }
+    return val;
+}
+#else
+template <typename Char> inline
+double string_to_double(const std::basic_string<Char>& s)
+{
     double val;
+    if (decimal_to_double(s.data(),s.size(),val))
+    {
+        return val;
+    }
+
+    std::basic_stringstream<Char> ss(s);
+    ss.imbue(std::locale::classic());
     ss >> val;
     if (ss.fail())
     {
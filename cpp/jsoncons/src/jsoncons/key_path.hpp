@@ -0,0 +1,100 @@
+// Copyright 2013 Daniel Parker
+// Distributed under the Boost license, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+// See https://sourceforge.net/projects/jsoncons/files/ for latest version
+// See https://sourceforge.net/p/jsoncons/wiki/Home/ for documentation.
+
+#ifndef JSONCONS_KEY_PATH_HPP
+#define JSONCONS_KEY_PATH_HPP
+
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <initializer_list>
+#include "jsoncons/json1.hpp"
+#include "jsoncons/json_structures.hpp"
+
+namespace jsoncons {
+
+// A chain of member names looked up in nested objects, e.g.
+// {"piecePosition","lane","startLaneIndex"}. Members of an object are kept
+// sorted, so documents of the same shape have each name at the same index;
+// the path remembers the index it found at each level and tries it first
+// next time, which costs one name compare: the names are from the key
+// table, as are those of parsed documents, so that is a pointer compare.
+// A document of another shape falls back to find_member and the new index
+// is remembered.
+template <typename Char,class Storage>
+class basic_key_path
+{
+public:
+    basic_key_path(std::initializer_list<const Char*> names)
+    {
+        for (const Char* name : names)
+        {
+            names_.push_back(basic_json_key<Char>(name,std::char_traits<Char>::length(name)));
+        }
+        hints_.assign(names_.size(),0);
+        misses_ = 0;
+    }
+
+    // The value at the end of the path, or null when some member is
+    // missing or the value on the way is not an object
+    const basic_json<Char,Storage>* find(const basic_json<Char,Storage>& root)
+    {
+        const basic_json<Char,Storage>* val = &root;
+        for (size_t i = 0; i < names_.size(); ++i)
+        {
+            if (!val->is_object())
+            {
+                return 0;
+            }
+            typename basic_json<Char,Storage>::const_object_iterator first = val->begin_members();
+            size_t size = val->size();
+            size_t index = hints_[i];
+            if (index >= size || first[index].key() != names_[i])
+            {
+                ++misses_;
+                typename basic_json<Char,Storage>::const_object_iterator it =
+                    find_member<Char,Storage>(first,first + size,names_[i]);
+                if (it == first + size)
+                {
+                    return 0;
+                }
+                index = it - first;
+                hints_[i] = index;
+            }
+            val = &first[index].value();
+        }
+        return val;
+    }
+
+    const basic_json<Char,Storage>& at(const basic_json<Char,Storage>& root)
+    {
+        const basic_json<Char,Storage>* val = find(root);
+        if (val == 0)
+        {
+            JSONCONS_THROW_EXCEPTION_1("Member %s not found.",names_.back().str());
+        }
+        return *val;
+    }
+
+    // Lookups that could not use the remembered index
+    size_t misses() const
+    {
+        return misses_;
+    }
+
+private:
+    std::vector<basic_json_key<Char>> names_;
+    std::vector<size_t> hints_;
+    size_t misses_;
+};
+
+typedef basic_key_path<char,storage<char>> key_path;
+typedef basic_key_path<wchar_t,storage<wchar_t>> wkey_path;
+
+}
+
+#endif
@@ -0,0 +1,229 @@
+// Copyright 2013 Daniel Parker
+// Distributed under the Boost license, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+// See https://sourceforge.net/projects/jsoncons/files/ for latest version
+// See https://sourceforge.net/p/jsoncons/wiki/Home/ for documentation.
+
+#ifndef JSONCONS_KEY_TABLE_HPP
+#define JSONCONS_KEY_TABLE_HPP
+
+#include <string>
+#include <mutex>
+#include <unordered_set>
+#include <cstddef>
+
+namespace jsoncons {
+
+// The member names of every document, each kept once for the life of the
+// process. Messages of a protocol use the same few dozen names over and
+// over, so members point at the one copy here rather than holding their
+// own. The table stops growing at max_size names; after that new names
+// are held by the members that use them (see basic_json_key).
+template <typename Char>
+class basic_key_table
+{
+public:
+    typedef std::basic_string<Char> string_type;
+
+    static const size_t max_size = 4096;
+
+    static basic_key_table& instance()
+    {
+        // never destroyed, members of static documents may outlive it
+        static basic_key_table* table = new basic_key_table();
+        return *table;
+    }
+
+    // The one copy of the name, or 0 when it is new and the table is full
+    const string_type* intern(const Char* s, size_t length)
+    {
+        string_type name(s,length);
+        std::lock_guard<std::mutex> lock(mutex_);
+        typename std::unordered_set<string_type>::const_iterator it = names_.find(name);
+        if (it != names_.end())
+        {
+            return &*it;
+        }
+        if (names_.size() >= max_size)
+        {
+            return 0;
+        }
+        return &*names_.insert(std::move(name)).first;
+    }
+
+    const string_type* empty_name() const
+    {
+        return empty_name_;
+    }
+
+    size_t size()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return names_.size();
+    }
+
+private:
+    basic_key_table()
+    {
+        empty_name_ = &*names_.insert(string_type()).first;
+    }
+    basic_key_table(const basic_key_table&);
+    basic_key_table& operator=(const basic_key_table&);
+
+    std::mutex mutex_;
+    std::unordered_set<string_type> names_;
+    const string_type* empty_name_;
+};
+
+template <typename Char>
+class basic_key_cache;
+
+// The name of a member: the table's copy, or a string of its own when the
+// table was full. Two names from the table are equal exactly when they
+// are the same string, so comparing them is comparing pointers.
+template <typename Char>
+class basic_json_key
+{
+    friend class basic_key_cache<Char>;
+public:
+    typedef std::basic_string<Char> string_type;
+
+    basic_json_key()
+        : name_(basic_key_table<Char>::instance().empty_name()), owned_(false)
+    {
+    }
+
+    basic_json_key(const Char* s, size_t length)
+    {
+        init(s,length);
+    }
+
+    explicit basic_json_key(const string_type& s)
+    {
+        init(s.data(),s.size());
+    }
+
+    basic_json_key(const basic_json_key& other)
+        : name_(other.owned_ ? new string_type(*other.name_) : other.name_), owned_(other.owned_)
+    {
+    }
+
+    basic_json_key(basic_json_key&& other) noexcept
+        : name_(other.name_), owned_(other.owned_)
+    {
+        other.name_ = basic_key_table<Char>::instance().empty_name();
+        other.owned_ = false;
+    }
+
+    ~basic_json_key()
+    {
+        if (owned_)
+        {
+            delete name_;
+        }
+    }
+
+    basic_json_key& operator=(basic_json_key other)
+    {
+        swap(other);
+        return *this;
+    }
+
+    void swap(basic_json_key& other) noexcept
+    {
+        std::swap(name_,other.name_);
+        std::swap(owned_,other.owned_);
+    }
+
+    const string_type& str() const
+    {
+        return *name_;
+    }
+
+    bool interned() const
+    {
+        return !owned_;
+    }
+
+    bool operator==(const basic_json_key& other) const
+    {
+        return name_ == other.name_ || ((owned_ || other.owned_) && *name_ == *other.name_);
+    }
+
+    bool operator!=(const basic_json_key& other) const
+    {
+        return !(*this == other);
+    }
+
+private:
+    explicit basic_json_key(const string_type* interned)
+        : name_(interned), owned_(false)
+    {
+    }
+
+    void init(const Char* s, size_t length)
+    {
+        name_ = basic_key_table<Char>::instance().intern(s,length);
+        owned_ = name_ == 0;
+        if (owned_)
+        {
+            name_ = new string_type(s,length);
+        }
+    }
+
+    const string_type* name_;
+    bool owned_;
+};
+
+// The names a parser has met, so that a name seen before is found without
+// taking the table's lock. Each slot remembers the last name that hashed
+// to it.
+template <typename Char>
+class basic_key_cache
+{
+public:
+    typedef std::basic_string<Char> string_type;
+
+    basic_key_cache()
+    {
+        for (size_t i = 0; i < slots; ++i)
+        {
+            names_[i] = 0;
+        }
+    }
+
+    basic_json_key<Char> get(const Char* s, size_t length)
+    {
+        size_t h = 2166136261u;
+        for (size_t i = 0; i < length; ++i)
+        {
+            h = (h ^ static_cast<size_t>(s[i])) * 16777619u;
+        }
+        const string_type*& slot = names_[h & (slots - 1)];
+        if (slot != 0 && slot->size() == length && std::char_traits<Char>::compare(slot->data(),s,length) == 0)
+        {
+            return basic_json_key<Char>(slot);
+        }
+        basic_json_key<Char> key(s,length);
+        if (key.interned())
+        {
+            slot = &key.str();
+        }
+        return key;
+    }
+
+private:
+    static const size_t slots = 256;
+
+    const string_type* names_[slots];
+};
+
+typedef basic_key_table<char> key_table;
+typedef basic_key_table<wchar_t> wkey_table;
+typedef basic_json_key<char> json_key;
+typedef basic_json_key<wchar_t> wjson_key;
+
+}
+
+#endif
@@ -88,6 +88,8 @@ public:
 
 //  Modifiers
 
+    // Significant digits of doubles; 0 writes the fewest digits that read
+    // back as the same double
     void precision(size_t prec)
     {
         precision_ = prec;
@@ -0,0 +1,921 @@
+// Copyright 2013 Daniel Parker
+// Distributed under the Boost license, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+// See https://sourceforge.net/projects/jsoncons/files/ for latest version
+// See https://sourceforge.net/p/jsoncons/wiki/Home/ for documentation.
+
+#ifndef JSONCONS_STRUCT_DECODER_HPP
+#define JSONCONS_STRUCT_DECODER_HPP
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <functional>
+#include <initializer_list>
+#include <type_traits>
+#include <cstdint>
+#include "jsoncons/jsoncons.hpp"
+#include "jsoncons/json_input_handler.hpp"
+#include "jsoncons/json_reader.hpp"
+
+namespace jsoncons {
+
+// Where the members of a struct T are in a json text. Specialize it with
+//
+//     static void describe(basic_struct_layout<Char,T>& layout);
+//
+// naming each member once, e.g.
+//
+//     layout.field({"piecePosition","lap"},&CarPosition::lap);
+//
+// and basic_struct_decoder fills a T while the text is read, without a
+// json tree in between.
+template <typename Char, class T>
+class json_fields;
+
+enum field_presence
+{
+    optional_field,
+    required_field
+};
+
+// A member name, or the names of nested objects down to it
+template <typename Char>
+class basic_field_path
+{
+public:
+    basic_field_path(const Char* name)
+        : names_(1,name)
+    {
+    }
+
+    basic_field_path(std::initializer_list<const Char*> names)
+        : names_(names)
+    {
+    }
+
+    const std::vector<const Char*>& names() const
+    {
+        return names_;
+    }
+
+private:
+    std::vector<const Char*> names_;
+};
+
+// Stores a json value in a member, or says that the member cannot hold it.
+// Numbers go into arithmetic members, strings into std::basic_string or
+// Char arrays (cut short and always terminated) and true/false into bool.
+template <typename Char, class M>
+struct field_traits
+{
+    static_assert(std::is_arithmetic<M>::value,"A field is a number, a bool, a string or a Char array");
+
+    static bool number(M& m, double val)
+    {
+        m = static_cast<M>(val);
+        return true;
+    }
+    static bool number(M& m, long long val)
+    {
+        m = static_cast<M>(val);
+        return true;
+    }
+    static bool number(M& m, unsigned long long val)
+    {
+        m = static_cast<M>(val);
+        return true;
+    }
+    static bool string(M&, const Char*, size_t)
+    {
+        return false;
+    }
+    static bool boolean(M&, bool)
+    {
+        return false;
+    }
+};
+
+template <typename Char>
+struct field_traits<Char,bool>
+{
+    template <class N>
+    static bool number(bool&, N)
+    {
+        return false;
+    }
+    static bool string(bool&, const Char*, size_t)
+    {
+        return false;
+    }
+    static bool boolean(bool& m, bool val)
+    {
+        m = val;
+        return true;
+    }
+};
+
+template <typename Char>
+struct field_traits<Char,std::basic_string<Char>>
+{
+    template <class N>
+    static bool number(std::basic_string<Char>&, N)
+    {
+        return false;
+    }
+    static bool string(std::basic_string<Char>& m, const Char* s, size_t length)
+    {
+        m.assign(s,length);
+        return true;
+    }
+    static bool boolean(std::basic_string<Char>&, bool)
+    {
+        return false;
+    }
+};
+
+template <typename Char, size_t N>
+struct field_traits<Char,Char[N]>
+{
+    template <class Number>
+    static bool number(Char (&)[N], Number)
+    {
+        return false;
+    }
+    static bool string(Char (&m)[N], const Char* s, size_t length)
+    {
+        length = length < N - 1 ? length : N - 1;
+        std::char_traits<Char>::copy(m,s,length);
+        m[length] = 0;
+        return true;
+    }
+    static bool boolean(Char (&)[N], bool)
+    {
+        return false;
+    }
+};
+
+// The parts of a layout, which reach the struct being filled through void*
+
+template <typename Char>
+class basic_field_setter
+{
+public:
+    virtual ~basic_field_setter() {}
+    virtual bool double_value(void* obj, double val) const = 0;
+    virtual bool longlong_value(void* obj, long long val) const = 0;
+    virtual bool ulonglong_value(void* obj, unsigned long long val) const = 0;
+    virtual bool string_value(void* obj, const Char* s, size_t length) const = 0;
+    virtual bool bool_value(void* obj, bool val) const = 0;
+};
+
+template <typename Char>
+class basic_member_access
+{
+public:
+    virtual ~basic_member_access() {}
+    virtual void* member(void* obj) const = 0;
+};
+
+template <typename Char>
+class basic_array_binding
+{
+public:
+    virtual ~basic_array_binding() {}
+    // Before the first element
+    virtual void begin(void* obj) const = 0;
+    // The element to fill next, or 0 when there is no room for it
+    virtual void* add(void* obj) const = 0;
+    // After the element is filled
+    virtual void added(void* obj, void* element) const = 0;
+    // An element that was never filled, after a failed decode
+    virtual void discard(void* element) const = 0;
+};
+
+template <typename Char>
+class basic_struct_layout_base
+{
+public:
+    struct node
+    {
+        enum kind_type
+        {
+            object_kind, // members of the struct one object down
+            value_kind,
+            struct_kind, // a member that is a struct with a layout of its own
+            array_kind   // an array of structs
+        };
+
+        node(kind_type k)
+            : kind(k), layout(0), bit(0)
+        {
+        }
+
+        const node* member(const Char* name, size_t length) const
+        {
+            for (size_t i = 0; i < members.size(); ++i)
+            {
+                const std::basic_string<Char>& s = members[i].first;
+                if (s.size() == length && std::char_traits<Char>::compare(s.data(),name,length) == 0)
+                {
+                    return members[i].second;
+                }
+            }
+            return 0;
+        }
+
+        kind_type kind;
+        std::vector<std::pair<std::basic_string<Char>,node*>> members;
+        std::unique_ptr<basic_field_setter<Char>> setter;
+        std::unique_ptr<basic_member_access<Char>> access;
+        std::unique_ptr<basic_array_binding<Char>> binding;
+        const basic_struct_layout_base* layout; // of the member, or of the elements
+        uint64_t bit; // for required members
+    };
+
+    virtual ~basic_struct_layout_base() {}
+
+    // Sets obj to a new struct with the layout's defaults
+    virtual void reset(void* obj) const = 0;
+
+    const node* root() const
+    {
+        return nodes_.front().get();
+    }
+
+    uint64_t required() const
+    {
+        return required_;
+    }
+
+protected:
+    basic_struct_layout_base()
+        : required_(0), required_count_(0)
+    {
+        nodes_.push_back(std::unique_ptr<node>(new node(node::object_kind)));
+    }
+
+    node* add_node(const basic_field_path<Char>& path, typename node::kind_type kind, field_presence presence)
+    {
+        const std::vector<const Char*>& names = path.names();
+        JSONCONS_ASSERT(!names.empty());
+        node* parent = nodes_.front().get();
+        for (size_t i = 0; i + 1 < names.size(); ++i)
+        {
+            node* child = const_cast<node*>(parent->member(names[i],std::char_traits<Char>::length(names[i])));
+            if (child == 0)
+            {
+                child = new_node(node::object_kind);
+                parent->members.push_back(std::make_pair(std::basic_string<Char>(names[i]),child));
+            }
+            else if (child->kind != node::object_kind)
+            {
+                JSONCONS_THROW_EXCEPTION_1("Member %s is both a field and an object",std::basic_string<Char>(names[i]));
+            }
+            parent = child;
+        }
+        const Char* name = names.back();
+        if (parent->member(name,std::char_traits<Char>::length(name)) != 0)
+        {
+            JSONCONS_THROW_EXCEPTION_1("Member %s is laid out twice",std::basic_string<Char>(name));
+        }
+        node* leaf = new_node(kind);
+        if (presence == required_field)
+        {
+            if (required_count_ == 64)
+            {
+                JSONCONS_THROW_EXCEPTION_1("More than 64 required members, at %s",std::basic_string<Char>(name));
+            }
+            leaf->bit = uint64_t(1) << required_count_++;
+            required_ |= leaf->bit;
+        }
+        parent->members.push_back(std::make_pair(std::basic_string<Char>(name),leaf));
+        return leaf;
+    }
+
+private:
+    basic_struct_layout_base(const basic_struct_layout_base&);
+    basic_struct_layout_base& operator=(const basic_struct_layout_base&);
+
+    node* new_node(typename node::kind_type kind)
+    {
+        nodes_.push_back(std::unique_ptr<node>(new node(kind)));
+        return nodes_.back().get();
+    }
+
+    std::vector<std::unique_ptr<node>> nodes_;
+    uint64_t required_;
+    size_t required_count_;
+};
+
+template <typename Char, class T>
+class basic_struct_layout : public basic_struct_layout_base<Char>
+{
+    typedef basic_struct_layout_base<Char> base;
+    typedef typename base::node node;
+public:
+    typedef basic_field_path<Char> path_type;
+
+    // Built from json_fields<Char,T> the first time it is asked for
+    static const basic_struct_layout& instance()
+    {
+        static const basic_struct_layout layout;
+        return layout;
+    }
+
+    void reset(void* obj) const
+    {
+        T& val = *static_cast<T*>(obj);
+        val = T();
+        for (size_t i = 0; i < defaults_.size(); ++i)
+        {
+            defaults_[i](val);
+        }
+    }
+
+    // A number, bool or string member
+    template <class M>
+    void field(const path_type& path, M T::*member, field_presence presence = optional_field)
+    {
+        this->add_node(path,node::value_kind,presence)->setter.reset(new member_setter<M>(member));
+    }
+
+    // An optional member with default_val when it is missing
+    template <class M, class V>
+    void field(const path_type& path, M T::*member, const V& default_val)
+    {
+        field(path,member);
+        M value = default_val;
+        defaults_.push_back([member,value](T& val) { val.*member = value; });
+    }
+
+    // A member that is a struct with json_fields of its own
+    template <class M>
+    void object(const path_type& path, M T::*member, field_presence presence = optional_field)
+    {
+        node* n = this->add_node(path,node::struct_kind,presence);
+        n->access.reset(new member_access<M>(member));
+        n->layout = &basic_struct_layout<Char,M>::instance();
+    }
+
+    // An array of structs into a vector
+    template <class E>
+    void array(const path_type& path, std::vector<E> T::*member, field_presence presence = optional_field)
+    {
+        node* n = this->add_node(path,node::array_kind,presence);
+        n->binding.reset(new vector_binding<E>(member));
+        n->layout = &basic_struct_layout<Char,E>::instance();
+    }
+
+    // An array of structs into a member array and a count; more elements
+    // than fit fail the decode
+    template <class E, size_t N, class C>
+    void array(const path_type& path, E (T::*member)[N], C T::*count, field_presence presence = optional_field)
+    {
+        node* n = this->add_node(path,node::array_kind,presence);
+        n->binding.reset(new fixed_binding<E,N,C>(member,count));
+        n->layout = &basic_struct_layout<Char,E>::instance();
+    }
+
+    // An array of structs each handed to f as it is read, for members that
+    // are not a plain copy of the json
+    template <class E>
+    void each(const path_type& path, void (*f)(T&, const E&), field_presence presence = optional_field)
+    {
+        node* n = this->add_node(path,node::array_kind,presence);
+        n->binding.reset(new callback_binding<E>(f));
+        n->layout = &basic_struct_layout<Char,E>::instance();
+    }
+
+    // A string that must be there and be value, e.g. the msgType of a message
+    void match(const path_type& path, const Char* value)
+    {
+        this->add_node(path,node::value_kind,required_field)->setter.reset(new match_setter(value));
+    }
+
+private:
+    basic_struct_layout()
+    {
+        json_fields<Char,T>::describe(*this);
+    }
+
+    template <class M>
+    class member_setter : public basic_field_setter<Char>
+    {
+    public:
+        member_setter(M T::*member)
+            : member_(member)
+        {
+        }
+        bool double_value(void* obj, double val) const
+        {
+            return field_traits<Char,M>::number(static_cast<T*>(obj)->*member_,val);
+        }
+        bool longlong_value(void* obj, long long val) const
+        {
+            return field_traits<Char,M>::number(static_cast<T*>(obj)->*member_,val);
+        }
+        bool ulonglong_value(void* obj, unsigned long long val) const
+        {
+            return field_traits<Char,M>::number(static_cast<T*>(obj)->*member_,val);
+        }
+        bool string_value(void* obj, const Char* s, size_t length) const
+        {
+            return field_traits<Char,M>::string(static_cast<T*>(obj)->*member_,s,length);
+        }
+        bool bool_value(void* obj, bool val) const
+        {
+            return field_traits<Char,M>::boolean(static_cast<T*>(obj)->*member_,val);
+        }
+    private:
+        M T::*member_;
+    };
+
+    class match_setter : public basic_field_setter<Char>
+    {
+    public:
+        match_setter(const Char* value)
+            : value_(value)
+        {
+        }
+        bool double_value(void*, double) const
+        {
+            return false;
+        }
+        bool longlong_value(void*, long long) const
+        {
+            return false;
+        }
+        bool ulonglong_value(void*, unsigned long long) const
+        {
+            return false;
+        }
+        bool string_value(void*, const Char* s, size_t length) const
+        {
+            return value_.size() == length && std::char_traits<Char>::compare(value_.data(),s,length) == 0;
+        }
+        bool bool_value(void*, bool) const
+        {
+            return false;
+        }
+    private:
+        std::basic_string<Char> value_;
+    };
+
+    template <class M>
+    class member_access : public basic_member_access<Char>
+    {
+    public:
+        member_access(M T::*member)
+            : member_(member)
+        {
+        }
+        void* member(void* obj) const
+        {
+            return &(static_cast<T*>(obj)->*member_);
+        }
+    private:
+        M T::*member_;
+    };
+
+    template <class E>
+    class vector_binding : public basic_array_binding<Char>
+    {
+    public:
+        vector_binding(std::vector<E> T::*member)
+            : member_(member)
+        {
+        }
+        void begin(void* obj) const
+        {
+            (static_cast<T*>(obj)->*member_).clear();
+        }
+        void* add(void* obj) const
+        {
+            std::vector<E>& v = static_cast<T*>(obj)->*member_;
+            v.push_back(E());
+            return &v.back();
+        }
+        void added(void*, void*) const
+        {
+        }
+        void discard(void*) const
+        {
+        }
+    private:
+        std::vector<E> T::*member_;
+    };
+
+    template <class E, size_t N, class C>
+    class fixed_binding : public basic_array_binding<Char>
+    {
+    public:
+        fixed_binding(E (T::*member)[N], C T::*count)
+            : member_(member), count_(count)
+        {
+        }
+        void begin(void* obj) const
+        {
+            static_cast<T*>(obj)->*count_ = 0;
+        }
+        void* add(void* obj) const
+        {
+            T& val = *static_cast<T*>(obj);
+            size_t count = static_cast<size_t>(val.*count_);
+            return count < N ? &(val.*member_)[count] : 0;
+        }
+        void added(void* obj, void*) const
+        {
+            ++(static_cast<T*>(obj)->*count_);
+        }
+        void discard(void*) const
+        {
+        }
+    private:
+        E (T::*member_)[N];
+        C T::*count_;
+    };
+
+    template <class E>
+    class callback_binding : public basic_array_binding<Char>
+    {
+    public:
+        callback_binding(void (*f)(T&, const E&))
+            : f_(f)
+        {
+        }
+        void begin(void*) const
+        {
+        }
+        void* add(void*) const
+        {
+            return new E();
+        }
+        void added(void* obj, void* element) const
+        {
+            std::unique_ptr<E> e(static_cast<E*>(element));
+            f_(*static_cast<T*>(obj),*e);
+        }
+        void discard(void* element) const
+        {
+            delete static_cast<E*>(element);
+        }
+    private:
+        void (*f_)(T&, const E&);
+    };
+
+    std::vector<std::function<void(T&)>> defaults_;
+};
+
+// Reads json texts straight into a T as laid out by json_fields<Char,T>.
+// Members that are not laid out are passed over unread. The reader and the
+// stack are kept from text to text, so after the first few decoding
+// allocates nothing beyond what T's own members do.
+template <typename Char, class T>
+class basic_struct_decoder : private basic_json_input_handler<Char>
+{
+    typedef basic_struct_layout_base<Char> layout_type;
+    typedef typename layout_type::node node;
+
+    struct frame
+    {
+        const node* node_;  // an object_kind or array_kind node
+        void* target_;      // the struct the members under node_ belong to
+        void* element_;     // arrays: the element being filled
+        uint64_t seen_;     // structs: the required members found so far
+        uint64_t required_; // structs: the required members
+        size_t owner_;      // the frame of the struct node_ belongs to
+    };
+public:
+    basic_struct_decoder()
+        : reader_(*this), layout_(basic_struct_layout<Char,T>::instance()), target_(0),
+          pending_(0), skip_(0), failed_(false), done_(false)
+    {
+    }
+
+    ~basic_struct_decoder()
+    {
+        discard();
+    }
+
+    // Fills val from the text, and says whether the text has the layout's
+    // shape: false for a value of the wrong type, a missing required member
+    // or more elements than a member array holds, and then val is partly
+    // filled. Text that is not json throws as basic_json_reader does.
+    bool decode(const Char* s, size_t length, T& val)
+    {
+        target_ = &val;
+        done_ = false;
+        reader_.read(s,length);
+        return done_ && !failed_;
+    }
+
+    bool decode(const std::basic_string<Char>& s, T& val)
+    {
+        return decode(s.data(),s.size(),val);
+    }
+
+private:
+    basic_struct_decoder(const basic_struct_decoder&);
+    basic_struct_decoder& operator=(const basic_struct_decoder&);
+
+    void begin_json()
+    {
+        discard();
+        stack_.clear();
+        pending_ = 0;
+        skip_ = 0;
+        failed_ = false;
+    }
+
+    void end_json()
+    {
+    }
+
+    void begin_object(const basic_parsing_context<Char>& context)
+    {
+        if (failed_)
+        {
+            return;
+        }
+        if (skip_ > 0)
+        {
+            ++skip_;
+            return;
+        }
+        if (stack_.empty())
+        {
+            layout_.reset(target_);
+            begin_struct(layout_,target_);
+            return;
+        }
+        frame& top = stack_.back();
+        if (top.node_->kind == node::array_kind)
+        {
+            void* element = top.node_->binding->add(top.target_);
+            if (element == 0)
+            {
+                failed_ = true;
+                return;
+            }
+            top.element_ = element;
+            top.node_->layout->reset(element);
+            begin_struct(*top.node_->layout,element);
+            return;
+        }
+        const node* n = next_member();
+        if (n == 0)
+        {
+            ++skip_;
+        }
+        else if (n->kind == node::object_kind)
+        {
+            frame f = {n, top.target_, 0, 0, 0, top.owner_};
+            stack_.push_back(f);
+        }
+        else if (n->kind == node::struct_kind)
+        {
+            void* member = n->access->member(top.target_);
+            n->layout->reset(member);
+            seen(n);
+            begin_struct(*n->layout,member);
+        }
+        else
+        {
+            failed_ = true;
+        }
+    }
+
+    void end_object(const basic_parsing_context<Char>& context)
+    {
+        if (failed_)
+        {
+            return;
+        }
+        if (skip_ > 0)
+        {
+            --skip_;
+            return;
+        }
+        frame f = stack_.back();
+        stack_.pop_back();
+        if (f.owner_ != stack_.size())
+        {
+            return;
+        }
+        if ((f.seen_ & f.required_) != f.required_)
+        {
+            failed_ = true;
+        }
+        else if (stack_.empty())
+        {
+            done_ = true;
+        }
+        else if (stack_.back().node_->kind == node::array_kind)
+        {
+            frame& parent = stack_.back();
+            parent.node_->binding->added(parent.target_,parent.element_);
+            parent.element_ = 0;
+        }
+    }
+
+    void begin_array(const basic_parsing_context<Char>& context)
+    {
+        if (failed_)
+        {
+            return;
+        }
+        if (skip_ > 0)
+        {
+            ++skip_;
+            return;
+        }
+        // the root and the elements of arrays are structs
+        if (stack_.empty() || stack_.back().node_->kind == node::array_kind)
+        {
+            failed_ = true;
+            return;
+        }
+        const node* n = next_member();
+        if (n == 0)
+        {
+            ++skip_;
+        }
+        else if (n->kind == node::array_kind)
+        {
+            frame& top = stack_.back();
+            n->binding->begin(top.target_);
+            seen(n);
+            frame f = {n, top.target_, 0, 0, 0, top.owner_};
+            stack_.push_back(f);
+        }
+        else
+        {
+            failed_ = true;
+        }
+    }
+
+    void end_array(const basic_parsing_context<Char>& context)
+    {
+        if (failed_)
+        {
+            return;
+        }
+        if (skip_ > 0)
+        {
+            --skip_;
+            return;
+        }
+        stack_.pop_back();
+    }
+
+    void name(const std::basic_string<Char>& name, const basic_parsing_context<Char>& context)
+    {
+        if (!failed_ && skip_ == 0)
+        {
+            pending_ = stack_.back().node_->member(name.data(),name.size());
+        }
+    }
+
+    // the reader moves past members that are not laid out, and past
+    // everything once the text does not fit
+    bool skip_value()
+    {
+        return failed_ || (skip_ == 0 && pending_ == 0);
+    }
+
+    void null_value(const basic_parsing_context<Char>& context)
+    {
+        // a member that is null is left as if it were missing
+        scalar();
+    }
+
+    void string_value(const std::basic_string<Char>& value, const basic_parsing_context<Char>& context)
+    {
+        const node* n = scalar();
+        if (n != 0)
+        {
+            store(n,n->setter->string_value(stack_.back().target_,value.data(),value.size()));
+        }
+    }
+
+    void double_value(double value, const basic_parsing_context<Char>& context)
+    {
+        const node* n = scalar();
+        if (n != 0)
+        {
+            store(n,n->setter->double_value(stack_.back().target_,value));
+        }
+    }
+
+    void longlong_value(long long value, const basic_parsing_context<Char>& context)
+    {
+        const node* n = scalar();
+        if (n != 0)
+        {
+            store(n,n->setter->longlong_value(stack_.back().target_,value));
+        }
+    }
+
+    void ulonglong_value(unsigned long long value, const basic_parsing_context<Char>& context)
+    {
+        const node* n = scalar();
+        if (n != 0)
+        {
+            store(n,n->setter->ulonglong_value(stack_.back().target_,value));
+        }
+    }
+
+    void bool_value(bool value, const basic_parsing_context<Char>& context)
+    {
+        const node* n = scalar();
+        if (n != 0)
+        {
+            store(n,n->setter->bool_value(stack_.back().target_,value));
+        }
+    }
+
+    void begin_struct(const layout_type& layout, void* obj)
+    {
+        frame f = {layout.root(), obj, 0, 0, layout.required(), stack_.size()};
+        stack_.push_back(f);
+    }
+
+    const node* next_member()
+    {
+        const node* n = pending_;
+        pending_ = 0;
+        return n;
+    }
+
+    // The value node a number, string, bool or null goes to, 0 when it is
+    // not laid out or the decode has failed
+    const node* scalar()
+    {
+        if (failed_ || skip_ > 0)
+        {
+            return 0;
+        }
+        if (stack_.empty() || stack_.back().node_->kind == node::array_kind)
+        {
+            failed_ = true;
+            return 0;
+        }
+        const node* n = next_member();
+        if (n != 0 && n->kind != node::value_kind)
+        {
+            failed_ = true;
+            return 0;
+        }
+        return n;
+    }
+
+    void store(const node* n, bool stored)
+    {
+        if (stored)
+        {
+            seen(n);
+        }
+        else
+        {
+            failed_ = true;
+        }
+    }
+
+    void seen(const node* n)
+    {
+        stack_[stack_.back().owner_].seen_ |= n->bit;
+    }
+
+    // Elements left half filled by a text that failed or threw
+    void discard()
+    {
+        for (size_t i = 0; i < stack_.size(); ++i)
+        {
+            if (stack_[i].element_ != 0)
+            {
+                stack_[i].node_->binding->discard(stack_[i].element_);
+                stack_[i].element_ = 0;
+            }
+        }
+    }
+
+    basic_json_reader<Char> reader_;
+    const layout_type& layout_;
+    void* target_;
+    std::vector<frame> stack_;
+    const node* pending_; // the member the next value is for
+    size_t skip_;         // depth inside a value that is not laid out
+    bool failed_;
+    bool done_;
+};
+
+template <class T>
+using struct_decoder = basic_struct_decoder<char,T>;
+template <class T>
+using wstruct_decoder = basic_struct_decoder<wchar_t,T>;
+
+}
+
+#endif
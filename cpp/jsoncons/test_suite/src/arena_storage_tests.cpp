@@ -0,0 +1,94 @@
+// Copyright 2013 Daniel Parker
+// Distributed under Boost license
+
+#include <boost/test/unit_test.hpp>
+#include "jsoncons/json.hpp"
+#include "jsoncons/arena_storage.hpp"
+#include <sstream>
+#include <string>
+
+using jsoncons::json;
+using jsoncons::arena_json;
+using jsoncons::arena_storage;
+using jsoncons::json_arena;
+using jsoncons::basic_json_parser;
+
+BOOST_AUTO_TEST_CASE(test_arena_json_parse)
+{
+    json_arena arena;
+    json_arena::scope scope(arena);
+
+    std::string text("{\"msgType\":\"carPositions\",\"data\":[{\"id\":{\"name\":\"a rather long name for sso\",\"color\":\"red\"},\"angle\":1.5}],\"gameTick\":3}");
+    arena_json val = arena_json::parse_string(text);
+    BOOST_CHECK(val["gameTick"].as<int>() == 3);
+    BOOST_CHECK(val["data"][0]["angle"].as<double>() == 1.5);
+    BOOST_CHECK(val["data"][0]["id"]["name"].as<std::string>() == "a rather long name for sso");
+    BOOST_CHECK(val.to_string() == json::parse_string(text).to_string());
+    BOOST_CHECK(arena.blocks() == 1);
+}
+
+BOOST_AUTO_TEST_CASE(test_arena_json_build_and_copy)
+{
+    json_arena arena;
+    json_arena::scope scope(arena);
+
+    arena_json val;
+    val["name"] = "a rather long name for sso";
+    val["values"] = arena_json(arena_json::an_array);
+    val["values"].add(1);
+    val["values"].add("two");
+    arena_json copy(val);
+    BOOST_CHECK(copy == val);
+    copy["values"].add(3.0);
+    BOOST_CHECK(val["values"].size() == 2);
+    BOOST_CHECK(copy["values"].size() == 3);
+    BOOST_CHECK(copy["name"].as<std::string>() == "a rather long name for sso");
+}
+
+BOOST_AUTO_TEST_CASE(test_arena_release_reuses_blocks)
+{
+    json_arena arena(256);
+    basic_json_parser<char,arena_storage<char>> parser;
+    arena_json val;
+
+    std::ostringstream os;
+    os << "[";
+    for (int i = 0; i < 100; ++i)
+    {
+        os << (i > 0 ? "," : "") << "{\"index\":" << i << ",\"name\":\"car number " << i << "\"}";
+    }
+    os << "]";
+    std::string text = os.str();
+
+    json_arena::scope scope(arena);
+    parser.parse(text,val);
+    BOOST_CHECK(val.size() == 100);
+    size_t blocks = arena.blocks();
+    BOOST_CHECK(blocks > 1);
+    for (int i = 0; i < 10; ++i)
+    {
+        arena_json().swap(val);
+        arena.release();
+        parser.parse(text,val);
+    }
+    BOOST_CHECK(arena.blocks() == blocks);
+    BOOST_CHECK(val[99]["name"].as<std::string>() == "car number 99");
+}
+
+BOOST_AUTO_TEST_CASE(test_arena_nested_scopes)
+{
+    json_arena outer;
+    json_arena inner;
+    json_arena::scope a(outer);
+    arena_json x = arena_json::parse_string("{\"a\":\"a string too long for sso\"}");
+    size_t outer_capacity = outer.capacity();
+    {
+        json_arena::scope b(inner);
+        arena_json y = arena_json::parse_string("[1,2,3]");
+        BOOST_CHECK(&json_arena::current() == &inner);
+        BOOST_CHECK(inner.blocks() == 1);
+    }
+    BOOST_CHECK(&json_arena::current() == &outer);
+    BOOST_CHECK(outer.capacity() == outer_capacity);
+    BOOST_CHECK(x["a"].as<std::string>() == "a string too long for sso");
+}
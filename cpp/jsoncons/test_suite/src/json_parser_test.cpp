@@ -8,6 +8,8 @@
 #include <vector>
 #include <utility>
 #include <ctime>
+#include <fstream>
+#include <iterator>
 #include "my_custom_data.hpp"
 
 using jsoncons::parsing_context;
@@ -15,6 +17,7 @@ using jsoncons::json_deserializer;
 using jsoncons::json;
 using jsoncons::wjson;
 using jsoncons::json_reader;
+using jsoncons::json_parser;
 using jsoncons::json_input_handler;
 using jsoncons::error_handler;
 using jsoncons::json_parse_exception;
@@ -119,3 +122,147 @@ BOOST_AUTO_TEST_CASE(test_escaped_characters)
 }
 
 
+
+BOOST_AUTO_TEST_CASE(test_parse_range_same_as_stream)
+{
+    const char* files[] = {"input/address-book.json","input/countries.json","input/employees.json",
+                           "input/members.json","input/persons.json"};
+    for (size_t i = 0; i < sizeof(files)/sizeof(files[0]); ++i)
+    {
+        std::ifstream is(files[i], std::ifstream::binary);
+        std::string text((std::istreambuf_iterator<char>(is)), std::istreambuf_iterator<char>());
+
+        json expected = json::parse_file(files[i]);
+        json o = json::parse(text.data(),text.length());
+        BOOST_CHECK(expected == o);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_parse_range_short_texts)
+{
+    const char* texts[] = {"1","[]","{}","true","false","null","-2.5","\"a\""," null ",
+                           "[1,2,3,4,5,6,7,8,9]","{\"a\":true,\"b\":null}"};
+    for (size_t i = 0; i < sizeof(texts)/sizeof(texts[0]); ++i)
+    {
+        std::istringstream is(texts[i]);
+        json expected = json::parse(is);
+        json o = json::parse(texts[i],strlen(texts[i]));
+        BOOST_CHECK(expected == o);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_parse_range_ignores_what_follows)
+{
+    std::string text("{\"name\":\"value\",\"flag\":true}");
+    std::string padded = text + "garbage, not json";
+
+    json o = json::parse(padded.data(),text.length());
+    BOOST_CHECK(o == json::parse_string(text));
+
+    // the read ahead ends inside the literal
+    std::string t = "[1,2,3,4,5,6,7,true]xxxx";
+    BOOST_CHECK(json::parse(t.data(),t.length() - 4)[7].as<bool>());
+}
+
+BOOST_AUTO_TEST_CASE(test_parse_range_unexpected_end)
+{
+    std::string text("{\"field1\":\"value\",\"field2\":{}");
+    json_deserializer handler;
+    my_error_handler err_handler("","JPE101");
+    json_reader reader(handler,err_handler);
+
+    BOOST_REQUIRE_THROW(reader.read(text.data(),text.length()), json_parse_exception);
+}
+
+BOOST_AUTO_TEST_CASE(test_json_parser_reuse)
+{
+    json_parser parser;
+    json val;
+
+    std::string a("{\"msgType\":\"carPositions\",\"data\":[{\"angle\":1.5}],\"gameTick\":3}");
+    parser.parse(a.data(),a.length(),val);
+    BOOST_CHECK(val["gameTick"].as<int>() == 3);
+    BOOST_CHECK(val["data"][0]["angle"].as<double>() == 1.5);
+
+    std::string b("[\"crash\",2]");
+    parser.parse(b,val);
+    BOOST_CHECK(val.is_array());
+    BOOST_CHECK(val[0].as<std::string>() == "crash");
+
+    // a failed parse leaves val as it was
+    std::string bad("{\"msgType\":\"gameEnd\",\"data\":[1,2");
+    BOOST_REQUIRE_THROW(parser.parse(bad,val), json_parse_exception);
+    BOOST_CHECK(val[1].as<int>() == 2);
+
+    parser.parse(a,val);
+    BOOST_CHECK(val == json::parse_string(a));
+    BOOST_CHECK(parser.parse(b.data(),b.length()) == json::parse_string(b));
+}
+
+BOOST_AUTO_TEST_CASE(test_parse_string_runs)
+{
+    // an escape, a quote or a multibyte character at every offset of
+    // strings longer than a vector, in place and from a stream
+    const char* specials[] = {"\\n","\\\"","\\u00e9","\xc3\xa9","\\\\"};
+    const char* decoded[] = {"\n","\"","\xc3\xa9","\xc3\xa9","\\"};
+    for (size_t k = 0; k < sizeof(specials)/sizeof(specials[0]); ++k)
+    {
+        for (size_t length = 0; length < 70; length += 3)
+        {
+            for (size_t at = 0; at <= length; ++at)
+            {
+                std::string text = "{\"key\":\"" + std::string(at,'a') + specials[k] + std::string(length - at,'b') + "\"}";
+                std::string expected = std::string(at,'a') + decoded[k] + std::string(length - at,'b');
+
+                json o = json::parse(text.data(),text.length());
+                BOOST_CHECK(o["key"].as<std::string>() == expected);
+                std::istringstream is(text);
+                BOOST_CHECK(json::parse(is)["key"].as<std::string>() == expected);
+            }
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_parse_string_control_character)
+{
+    std::string text = "[\"" + std::string(37,'x') + "\x01" + "\"]";
+    json_deserializer handler;
+    my_error_handler err_handler("JPE201","");
+    json_reader reader(handler,err_handler);
+
+    try
+    {
+        reader.read(text.data(),text.length());
+        BOOST_FAIL("no error");
+    }
+    catch (const json_parse_exception& e)
+    {
+        BOOST_CHECK(e.line_number() == 1);
+        BOOST_CHECK(e.column_number() == 40);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_parse_blank_runs)
+{
+    std::string text = "[\n\t\t  \t" + std::string(37,' ') + "1,\r\n" + std::string(33,'\t') + "2,\n  [  " + std::string(50,' ') + "\"x\"\t\t]\n]";
+    json o = json::parse(text.data(),text.length());
+    BOOST_CHECK(o.size() == 3);
+    BOOST_CHECK(o[1].as<int>() == 2);
+    BOOST_CHECK(o[2][0].as<std::string>() == "x");
+
+    // where an error is reported does not change with the run lengths
+    std::string bad = "{\n" + std::string(40,' ') + "\"a\"" + std::string(20,' ') + "1}";
+    json_deserializer handler;
+    my_error_handler err_handler("","JPE106");
+    json_reader reader(handler,err_handler);
+    try
+    {
+        reader.read(bad.data(),bad.length());
+        BOOST_FAIL("no error");
+    }
+    catch (const json_parse_exception& e)
+    {
+        BOOST_CHECK(e.line_number() == 2);
+        BOOST_CHECK(e.column_number() == 64);
+    }
+}
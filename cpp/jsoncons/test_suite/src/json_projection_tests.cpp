@@ -0,0 +1,113 @@
+// Copyright 2013 Daniel Parker
+// Distributed under Boost license
+
+#include <boost/test/unit_test.hpp>
+#include "jsoncons/json.hpp"
+#include "jsoncons/json_parser.hpp"
+#include "jsoncons/json_filter.hpp"
+#include <sstream>
+#include <string>
+
+using jsoncons::json;
+using jsoncons::json_parser;
+using jsoncons::json_reader;
+using jsoncons::json_deserializer;
+using jsoncons::json_filter;
+using jsoncons::json_projection;
+using jsoncons::json_input_handler;
+using jsoncons::json_parse_exception;
+
+namespace {
+
+const std::string message =
+    "{\"msgType\":\"gameInit\",\n"
+    " \"data\":{\"race\":{\n"
+    "   \"track\":{\"id\":\"keimola\",\"pieces\":[{\"length\":100.0},{\"radius\":200,\"angle\":-22.5,\"switch\":true}]},\n"
+    "   \"cars\":[{\"id\":{\"name\":\"a \\\"quoted\\\" } ] name\",\"color\":\"red\"},\"dimensions\":{\"length\":40.0}},\n"
+    "             {\"id\":{\"name\":\"b\\\\\",\"color\":\"blue\"},\"dimensions\":{\"length\":4e1}}],\n"
+    "   \"raceSession\" : {\"laps\":3, \"quickRace\":true, \"empty\":[[],{}], \"none\":null} ,\n"
+    "   \"last\":-1.5e-3}},\n"
+    " \"gameTick\" : 12 }";
+
+// Reports every value, as readers other than basic_json_reader do
+class no_skipping : public json_filter
+{
+public:
+    no_skipping(json_input_handler& parent)
+        : json_filter(parent)
+    {
+    }
+
+    virtual bool skip_value()
+    {
+        return false;
+    }
+};
+
+}
+
+BOOST_AUTO_TEST_CASE(test_json_projection)
+{
+    json_parser parser { { "msgType" }, { "data", "race", "track" }, { "data", "race", "cars", "id", "color" } };
+    json val;
+    parser.parse(message,val);
+    json expected = json::parse_string(
+        "{\"msgType\":\"gameInit\",\"data\":{\"race\":{"
+        "\"track\":{\"id\":\"keimola\",\"pieces\":[{\"length\":100.0},{\"radius\":200,\"angle\":-22.5,\"switch\":true}]},"
+        "\"cars\":[{\"id\":{\"color\":\"red\"}},{\"id\":{\"color\":\"blue\"}}]}}}");
+    BOOST_CHECK(val == expected);
+
+    // the same members when nothing is passed over
+    json_deserializer handler;
+    json_projection projection(handler, { { "msgType" }, { "data", "race", "track" }, { "data", "race", "cars", "id", "color" } });
+    no_skipping source(projection);
+    json_reader reader(source);
+    reader.read(message.data(),message.size());
+    BOOST_CHECK(handler.root() == expected);
+
+    // and when the text comes a few characters at a time
+    std::istringstream is(message);
+    json_deserializer streamed;
+    json_projection tracks(streamed, { { "data", "race", "track", "pieces" }, { "gameTick" } });
+    json_reader stream_reader(is,tracks);
+    stream_reader.buffer_capacity(16);
+    stream_reader.read();
+    BOOST_CHECK(streamed.root() == json::parse_string(
+        "{\"data\":{\"race\":{\"track\":{\"pieces\":[{\"length\":100.0},{\"radius\":200,\"angle\":-22.5,\"switch\":true}]}}},\"gameTick\":12}"));
+
+    // a path inside another keeps all of the outer one
+    json_parser nested { { "data", "race", "raceSession", "laps" }, { "data", "race", "raceSession" } };
+    nested.parse(message,val);
+    BOOST_CHECK(val["data"]["race"]["raceSession"].size() == 4);
+
+    // no paths, everything
+    json_deserializer everything;
+    json_projection all(everything);
+    json_reader all_reader(all);
+    all_reader.read(message.data(),message.size());
+    BOOST_CHECK(everything.root() == json::parse_string(message));
+}
+
+BOOST_AUTO_TEST_CASE(test_json_projection_errors)
+{
+    json_parser parser { { "kept" } };
+    json val;
+    // what is passed over still has to be there and be balanced
+    BOOST_CHECK_THROW(parser.parse(std::string("{\"kept\":1,\"dropped\":}"),val),json_parse_exception);
+    BOOST_CHECK_THROW(parser.parse(std::string("{\"kept\":1,\"dropped\":[1,{\"a\":\"]\"}"),val),json_parse_exception);
+    BOOST_CHECK_THROW(parser.parse(std::string("{\"dropped\":\"open"),val),json_parse_exception);
+
+    // lines are still counted
+    try
+    {
+        parser.parse(std::string("{\"dropped\":[1,\n2,\n3],\n\"kept\":}"),val);
+        BOOST_CHECK(false);
+    }
+    catch (const json_parse_exception& e)
+    {
+        BOOST_CHECK(e.line_number() == 4);
+    }
+
+    parser.parse(std::string("{\"dropped\":true,\"kept\":[false]}"),val);
+    BOOST_CHECK(val == json::parse_string("{\"kept\":[false]}"));
+}
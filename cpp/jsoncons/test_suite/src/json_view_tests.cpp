@@ -0,0 +1,65 @@
+// Copyright 2013 Daniel Parker
+// Distributed under Boost license
+
+#include <boost/test/unit_test.hpp>
+#include "jsoncons/json.hpp"
+#include "jsoncons/json_view.hpp"
+#include "jsoncons/arena_storage.hpp"
+#include <string>
+#include <vector>
+
+using jsoncons::json;
+using jsoncons::json_view;
+using jsoncons::json_exception;
+
+BOOST_AUTO_TEST_CASE(test_json_view_members)
+{
+    json val = json::parse_string("{\"id\":{\"name\":\"a\",\"color\":\"red\"},\"angle\":1.5,\"a_rather_long_member_name\":3}");
+    const json& cval = val;
+    json_view view(val);
+
+    BOOST_CHECK(view["id"]["color"].as<std::string>() == "red");
+    BOOST_CHECK(&view["id"]["name"].json() == &cval["id"]["name"]);
+    BOOST_CHECK(view[std::string("angle")].as<double>() == 1.5);
+    BOOST_CHECK(view["a_rather_long_member_name"].as<int>() == 3);
+    BOOST_CHECK(view.has_member("angle"));
+    BOOST_CHECK(!view.has_member("angl"));
+    BOOST_CHECK(!view["angle"].has_member("x"));
+    BOOST_CHECK(view.get("nosuch").is_null());
+    BOOST_CHECK(view.get("angle",0.0) == 1.5);
+    BOOST_CHECK(view.get("nosuch",2.5) == 2.5);
+    BOOST_CHECK(view["id"].get("name",std::string()) == "a");
+    BOOST_CHECK_THROW(view["nosuch"],json_exception);
+    BOOST_CHECK_THROW(view["angle"]["x"],json_exception);
+}
+
+BOOST_AUTO_TEST_CASE(test_json_view_elements)
+{
+    json val = json::parse_string("{\"cars\":[{\"lap\":1},{\"lap\":2},{\"lap\":3}],\"empty\":{}}");
+    const json& cval = val;
+    json_view cars = json_view(val)["cars"];
+
+    BOOST_CHECK(cars.size() == 3);
+    BOOST_CHECK(cars[2]["lap"].as<int>() == 3);
+    int sum = 0;
+    for (json_view car : cars)
+    {
+        sum += car["lap"].as<int>();
+    }
+    BOOST_CHECK(sum == 6);
+
+    std::vector<json_view> elements = val["cars"].as<std::vector<json_view>>();
+    BOOST_CHECK(elements.size() == 3);
+    BOOST_CHECK(&elements[1].json() == &cval["cars"][1]);
+    BOOST_CHECK(!json_view(val)["empty"].has_member("x"));
+    BOOST_CHECK(json_view(val)["empty"].get("x",1) == 1);
+}
+
+BOOST_AUTO_TEST_CASE(test_json_view_arena)
+{
+    jsoncons::json_arena arena;
+    jsoncons::json_arena::scope in_arena(arena);
+    jsoncons::arena_json val = jsoncons::arena_json::parse_string("{\"data\":{\"gameTick\":5}}");
+    BOOST_CHECK(jsoncons::view_of(val)["data"].get("gameTick",-1) == 5);
+    BOOST_CHECK(jsoncons::view_of(val).get("gameTick",-1) == -1);
+}
@@ -0,0 +1,47 @@
+// Copyright 2013 Daniel Parker
+// Distributed under Boost license
+
+#include <boost/test/unit_test.hpp>
+#include "jsoncons/json.hpp"
+#include "jsoncons/key_path.hpp"
+#include <string>
+
+using jsoncons::json;
+using jsoncons::key_path;
+using jsoncons::json_exception;
+
+BOOST_AUTO_TEST_CASE(test_key_path_same_shape)
+{
+    json a = json::parse_string("{\"id\":{\"name\":\"a\",\"color\":\"red\"},\"angle\":1.5}");
+    json b = json::parse_string("{\"id\":{\"name\":\"b\",\"color\":\"blue\"},\"angle\":2.5}");
+    key_path color {"id","color"};
+
+    BOOST_CHECK(color.at(a).as<std::string>() == "red");
+    size_t misses = color.misses();
+    BOOST_CHECK(color.at(b).as<std::string>() == "blue");
+    BOOST_CHECK(color.at(a).as<std::string>() == "red");
+    BOOST_CHECK(color.misses() == misses);
+}
+
+BOOST_AUTO_TEST_CASE(test_key_path_other_shape)
+{
+    json a = json::parse_string("{\"b\":1,\"c\":{\"x\":2}}");
+    json b = json::parse_string("{\"a\":0,\"b\":1,\"c\":{\"w\":3,\"x\":4}}");
+    key_path x {"c","x"};
+
+    BOOST_CHECK(x.at(a).as<int>() == 2);
+    BOOST_CHECK(x.at(b).as<int>() == 4);
+    BOOST_CHECK(x.at(a).as<int>() == 2);
+}
+
+BOOST_AUTO_TEST_CASE(test_key_path_missing)
+{
+    json a = json::parse_string("{\"b\":1,\"c\":[1,2]}");
+    key_path x {"c","x"};
+    key_path y {"d"};
+
+    BOOST_CHECK(x.find(a) == 0);
+    BOOST_CHECK(y.find(a) == 0);
+    BOOST_CHECK(y.find(json()) == 0);
+    BOOST_REQUIRE_THROW(x.at(a), json_exception);
+}
@@ -0,0 +1,118 @@
+// Copyright 2013 Daniel Parker
+// Distributed under Boost license
+
+#include <boost/test/unit_test.hpp>
+#include "jsoncons/json.hpp"
+#include "jsoncons/key_path.hpp"
+#include <string>
+#include <sstream>
+
+using jsoncons::json;
+using jsoncons::wjson;
+using jsoncons::json_key;
+using jsoncons::key_path;
+
+BOOST_AUTO_TEST_CASE(test_small_strings)
+{
+    json small("Right");
+    json full("1234567");
+    json large("12345678");
+    BOOST_CHECK(small.type() == json::string_t);
+    BOOST_CHECK(large.type() == json::string_t);
+    BOOST_CHECK(small.is_string() && full.is_string() && large.is_string());
+    BOOST_CHECK(small.as_string() == "Right");
+    BOOST_CHECK(full.as_string() == "1234567");
+    BOOST_CHECK(large.as_string() == "12345678");
+    BOOST_CHECK(json(std::string()).is_empty());
+    BOOST_CHECK(small.as_char() == 'R');
+    BOOST_CHECK(small == json(std::string("Right")));
+    BOOST_CHECK(small != json("Left"));
+    BOOST_CHECK(full != large);
+
+    json copy(small);
+    json moved(std::move(copy));
+    BOOST_CHECK(moved.as_string() == "Right");
+    moved = large;
+    BOOST_CHECK(moved == large);
+    moved = std::string("red");
+    BOOST_CHECK(moved.as_string() == "red");
+    moved.swap(large);
+    BOOST_CHECK(moved.as_string() == "12345678" && large.as_string() == "red");
+
+    json val = json::parse_string("{\"color\":\"red\",\"name\":\"Schumacher\",\"empty\":\"\",\"escaped\":\"a\\\"b\"}");
+    BOOST_CHECK(val["color"].as_string() == "red");
+    BOOST_CHECK(val["name"].as_string() == "Schumacher");
+    BOOST_CHECK(val["empty"].as_string() == "");
+    BOOST_CHECK(val["escaped"].as_string() == "a\"b");
+    BOOST_CHECK(val.to_string() == "{\"color\":\"red\",\"empty\":\"\",\"escaped\":\"a\\\"b\",\"name\":\"Schumacher\"}");
+
+    wjson w(L"ab");
+    BOOST_CHECK(w.as_string() == L"ab" && w == wjson(std::wstring(L"ab")));
+}
+
+BOOST_AUTO_TEST_CASE(test_interned_member_names)
+{
+    json a = json::parse_string("{\"piecePosition\":{\"pieceIndex\":1},\"angle\":0.5}");
+    json b = json::parse_string("{\"angle\":2,\"piecePosition\":{\"pieceIndex\":3}}");
+    const json& ca = a;
+    const json& cb = b;
+    // the same string, not equal strings
+    BOOST_CHECK(&ca.begin_members()->name() == &cb.begin_members()->name());
+    BOOST_CHECK(ca.begin_members()->key() == json_key("angle",5));
+    BOOST_CHECK(ca.begin_members()->key() != json_key("angles",6));
+
+    a["added"] = 1;
+    BOOST_CHECK(&ca.begin_members()->name() == &json_key("added",5).str());
+
+    key_path index { "piecePosition", "pieceIndex" };
+    BOOST_CHECK(index.at(a).as<int>() == 1);
+    BOOST_CHECK(index.at(b).as<int>() == 3);
+    BOOST_CHECK(index.misses() == 2);
+
+    // beyond the linear scan of small objects
+    std::ostringstream os;
+    os << "{";
+    for (int i = 0; i < 40; ++i)
+    {
+        os << (i > 0 ? "," : "") << "\"member" << i << "\":" << i;
+    }
+    os << "}";
+    json wide = json::parse_string(os.str());
+    key_path member { "member27" };
+    BOOST_CHECK(member.at(wide).as<int>() == 27);
+    BOOST_CHECK(wide["member39"].as<int>() == 39);
+    BOOST_CHECK(!wide.has_member("member40"));
+}
+
+BOOST_AUTO_TEST_CASE(test_full_key_table)
+{
+    // a table of its own, filled up
+    typedef jsoncons::basic_key_table<char16_t> table_type;
+    typedef jsoncons::basic_json_key<char16_t> key_type;
+    table_type& table = table_type::instance();
+    std::u16string first = u"first";
+    key_type interned(first);
+    for (size_t i = 0; table.size() < table_type::max_size; ++i)
+    {
+        std::u16string name(u"n");
+        name.push_back(static_cast<char16_t>(u'a' + i % 26));
+        name.push_back(static_cast<char16_t>(u'a' + i / 26 % 26));
+        name.push_back(static_cast<char16_t>(u'a' + i / 676 % 26));
+        key_type key(name);
+    }
+    BOOST_CHECK(table.size() == table_type::max_size);
+
+    key_type owned(std::u16string(u"late"));
+    key_type again(std::u16string(u"first"));
+    BOOST_CHECK(interned.interned() && again.interned() && !owned.interned());
+    BOOST_CHECK(&again.str() == &interned.str());
+    BOOST_CHECK(owned.str() == u"late");
+
+    key_type copy(owned);
+    BOOST_CHECK(!copy.interned() && &copy.str() != &owned.str() && copy == owned);
+    key_type moved(std::move(copy));
+    BOOST_CHECK(moved == owned && copy.str().empty());
+    moved = interned;
+    BOOST_CHECK(moved.interned() && moved == interned && moved != owned);
+    BOOST_CHECK(table.size() == table_type::max_size);
+}
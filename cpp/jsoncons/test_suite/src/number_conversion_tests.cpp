@@ -0,0 +1,209 @@
+// Copyright 2013 Daniel Parker
+// Distributed under Boost license
+
+#include <boost/test/unit_test.hpp>
+#include "jsoncons/json.hpp"
+#include "jsoncons/number_conversion.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <random>
+
+using jsoncons::json;
+using jsoncons::output_format;
+
+static bool same_bits(double a, double b)
+{
+    return std::memcmp(&a,&b,sizeof(double)) == 0;
+}
+
+static double random_double(std::mt19937_64& rng, int kind)
+{
+    double x;
+    switch (kind % 3)
+    {
+    case 0:
+        {
+            uint64_t bits = rng();
+            std::memcpy(&x,&bits,sizeof(x));
+            if (x != x || x - x != 0)
+            {
+                x = 1.5;
+            }
+        }
+        break;
+    case 1:
+        x = static_cast<double>(rng() % 2000000) / 1000.0 - 1000.0;
+        break;
+    default:
+        x = std::ldexp(static_cast<double>(rng() >> 11),static_cast<int>(rng() % 200) - 150);
+        break;
+    }
+    return x;
+}
+
+// digits of the mantissa without the zeros at either end
+static int significant_digits(const std::string& s)
+{
+    std::string digits;
+    for (size_t i = 0; i < s.size() && s[i] != 'e'; ++i)
+    {
+        if (s[i] >= '0' && s[i] <= '9')
+        {
+            digits.push_back(s[i]);
+        }
+    }
+    size_t first = digits.find_first_not_of('0');
+    if (first == std::string::npos)
+    {
+        return 1;
+    }
+    return static_cast<int>(digits.find_last_not_of('0') - first + 1);
+}
+
+BOOST_AUTO_TEST_CASE(test_decimal_to_double_against_strtod)
+{
+    std::mt19937_64 rng(1);
+    char buf[64];
+    int mismatches = 0;
+    for (int i = 0; i < 100000; ++i)
+    {
+        double x = random_double(rng,i);
+        int digits = 1 + static_cast<int>(rng() % 19);
+        std::snprintf(buf,sizeof(buf),"%.*e",digits - 1,x);
+        double val;
+        if (jsoncons::decimal_to_double(buf,std::strlen(buf),val))
+        {
+            mismatches += !same_bits(val,std::strtod(buf,0));
+        }
+        std::snprintf(buf,sizeof(buf),"%.17g",x);
+        BOOST_REQUIRE(jsoncons::decimal_to_double(buf,std::strlen(buf),val));
+        mismatches += !same_bits(val,x);
+    }
+    BOOST_CHECK_EQUAL(mismatches,0);
+}
+
+BOOST_AUTO_TEST_CASE(test_decimal_to_double_edges)
+{
+    const char* cases[] = {"0", "-0", "1e400", "-1e400", "1e-400",
+                           "2.2250738585072011e-308", "4.9406564584124654e-324",
+                           "2.4703282292062327e-324", "2.4703282292062328e-324",
+                           "9007199254740993", "9007199254740992.5", "9007199254740993.0000000001",
+                           "1.7976931348623157e308", "1.7976931348623159e308",
+                           "0.000000000000000000000000000000001", "10000000000000000000000000",
+                           "7.2057594037927933e16", "1E5", "1e+05", "123.456e-2"};
+    for (size_t i = 0; i < sizeof(cases)/sizeof(cases[0]); ++i)
+    {
+        double val;
+        if (jsoncons::decimal_to_double(cases[i],std::strlen(cases[i]),val))
+        {
+            BOOST_CHECK_MESSAGE(same_bits(val,std::strtod(cases[i],0)),cases[i]);
+        }
+        BOOST_CHECK(same_bits(jsoncons::string_to_double(std::string(cases[i])),std::strtod(cases[i],0)));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_decimal_to_double_declines)
+{
+    // left to the library, which gives the same answers as before
+    const char* cases[] = {"", "-", "1.", ".5", "1e", "1e+", "+1", " 1", "1 ", "0x10", "inf", "nan",
+                           "1.00000000000000011102230246251565404236316680908203125"};
+    for (size_t i = 0; i < sizeof(cases)/sizeof(cases[0]); ++i)
+    {
+        double val = 0;
+        BOOST_CHECK_MESSAGE(!jsoncons::decimal_to_double(cases[i],std::strlen(cases[i]),val),cases[i]);
+    }
+    // just above halfway between 1 and the next double
+    BOOST_CHECK(jsoncons::string_to_double(std::string("1.000000000000000111022302462515654042363166809082031251")) ==
+                1.0000000000000002);
+    BOOST_CHECK(jsoncons::string_to_double(std::wstring(L"1.000000000000000111022302462515654042363166809082031251")) ==
+                1.0000000000000002);
+    BOOST_CHECK(jsoncons::string_to_double(std::wstring(L"-0.25")) == -0.25);
+}
+
+BOOST_AUTO_TEST_CASE(test_format_double_against_stream)
+{
+    std::mt19937_64 rng(2);
+    int fast = 0;
+    int mismatches = 0;
+    for (int i = 0; i < 100000; ++i)
+    {
+        double x = random_double(rng,i);
+        size_t precision = 1 + rng() % 17;
+        std::string expected = jsoncons::stream_double_to_string<char>(x,precision);
+        if (expected.find(".e") != std::string::npos)
+        {
+            // the stream drops the zeros when rounding carries into the
+            // exponent form (see test_format_double_carry)
+            continue;
+        }
+        char buf[jsoncons::double_buffer_size];
+        size_t length = jsoncons::format_double(buf,x,precision);
+        if (length > 0)
+        {
+            ++fast;
+            mismatches += std::string(buf,length) != expected;
+        }
+        mismatches += jsoncons::double_to_string<char>(x,precision) != expected;
+    }
+    BOOST_CHECK_EQUAL(mismatches,0);
+    BOOST_CHECK(fast > 50000);
+}
+
+BOOST_AUTO_TEST_CASE(test_format_double_carry)
+{
+    BOOST_CHECK(jsoncons::double_to_string<char>(999.713,3) == "1.0e+03");
+    BOOST_CHECK(jsoncons::double_to_string<char>(-99.813,2) == "-1.0e+02");
+    BOOST_CHECK(jsoncons::double_to_string<char>(9.9999,3) == "10.0");
+    BOOST_CHECK(jsoncons::double_to_string<char>(1e15,16) == "1000000000000000.");
+    BOOST_CHECK(jsoncons::double_to_string<char>(-0.0,16) == "-0.0");
+}
+
+BOOST_AUTO_TEST_CASE(test_shortest_double_to_string)
+{
+    BOOST_CHECK(jsoncons::double_to_string<char>(0.1,0) == "0.1");
+    BOOST_CHECK(jsoncons::double_to_string<char>(0.1 + 0.2,0) == "0.30000000000000004");
+    BOOST_CHECK(jsoncons::double_to_string<char>(1.1,0) == "1.1");
+    BOOST_CHECK(jsoncons::double_to_string<char>(100,0) == "100.0");
+    BOOST_CHECK(jsoncons::double_to_string<char>(1e22,0) == "1.0e+22");
+    BOOST_CHECK(jsoncons::double_to_string<char>(0,0) == "0.0");
+    BOOST_CHECK(jsoncons::double_to_string<wchar_t>(0.1 + 0.2,0) == L"0.30000000000000004");
+
+    // reads back the same and has no more digits than the shortest %.*g
+    std::mt19937_64 rng(3);
+    char buf[64];
+    int wrong = 0;
+    int longer = 0;
+    for (int i = 0; i < 20000; ++i)
+    {
+        double x = random_double(rng,i);
+        std::string s = jsoncons::double_to_string<char>(x,0);
+        wrong += !same_bits(std::strtod(s.c_str(),0),x);
+        int digits = 1;
+        for (; digits < 17; ++digits)
+        {
+            std::snprintf(buf,sizeof(buf),"%.*e",digits - 1,x);
+            if (std::strtod(buf,0) == x)
+            {
+                break;
+            }
+        }
+        longer += significant_digits(s) > digits;
+    }
+    BOOST_CHECK_EQUAL(wrong,0);
+    BOOST_CHECK_EQUAL(longer,0);
+}
+
+BOOST_AUTO_TEST_CASE(test_serializer_precision)
+{
+    json val(json::an_array);
+    val.add(0.1 + 0.2);
+    val.add(1.5);
+    val.add(1e-300);
+    output_format format;
+    BOOST_CHECK(val.to_string(format) == "[0.3,1.5,1.0e-300]");
+    format.precision(0);
+    BOOST_CHECK(val.to_string(format) == "[0.30000000000000004,1.5,1.0e-300]");
+    BOOST_CHECK(json::parse_string(val.to_string(format))[0].as<double>() == 0.1 + 0.2);
+}
@@ -0,0 +1,164 @@
+// Copyright 2013 Daniel Parker
+// Distributed under Boost license
+
+#include <boost/test/unit_test.hpp>
+#include "jsoncons/json.hpp"
+#include "jsoncons/struct_decoder.hpp"
+#include <string>
+#include <vector>
+#include <cstring>
+
+using jsoncons::struct_decoder;
+using jsoncons::basic_struct_layout;
+using jsoncons::required_field;
+
+namespace {
+
+struct point
+{
+    double x;
+    double y;
+};
+
+struct label
+{
+    char text[8];
+    int weight;
+};
+
+struct shape
+{
+    std::string name;
+    bool closed;
+    int sides;
+    point origin;
+    std::vector<point> corners;
+    label labels[2];
+    size_t nlabels;
+    double perimeter; // from each of the edges
+};
+
+struct edge
+{
+    double length;
+};
+
+}
+
+namespace jsoncons {
+
+template <>
+class json_fields<char,point>
+{
+public:
+    static void describe(basic_struct_layout<char,point>& layout)
+    {
+        layout.field("x",&point::x,required_field);
+        layout.field("y",&point::y,required_field);
+    }
+};
+
+template <>
+class json_fields<char,label>
+{
+public:
+    static void describe(basic_struct_layout<char,label>& layout)
+    {
+        layout.field("text",&label::text);
+        layout.field({"style","weight"},&label::weight,400);
+    }
+};
+
+template <>
+class json_fields<char,edge>
+{
+public:
+    static void describe(basic_struct_layout<char,edge>& layout)
+    {
+        layout.field("length",&edge::length,required_field);
+    }
+};
+
+template <>
+class json_fields<char,shape>
+{
+public:
+    static void describe(basic_struct_layout<char,shape>& layout)
+    {
+        layout.match("type","shape");
+        layout.field({"meta","name"},&shape::name,required_field);
+        layout.field({"meta","closed"},&shape::closed);
+        layout.field("sides",&shape::sides,-1);
+        layout.object("origin",&shape::origin);
+        layout.array("corners",&shape::corners);
+        layout.array("labels",&shape::labels,&shape::nlabels);
+        layout.each("edges",&add_edge);
+    }
+
+private:
+    static void add_edge(shape& s, const edge& e)
+    {
+        s.perimeter += e.length;
+    }
+};
+
+}
+
+BOOST_AUTO_TEST_CASE(test_struct_decoder)
+{
+    struct_decoder<shape> decoder;
+    shape s;
+    std::string text = "{\"extra\":{\"deep\":[1,{\"x\":2}]},\"type\":\"shape\","
+        "\"meta\":{\"name\":\"triangle\",\"closed\":true,\"unused\":null},"
+        "\"origin\":{\"x\":1,\"y\":-2.5},"
+        "\"corners\":[{\"x\":0,\"y\":0},{\"y\":1,\"x\":0,\"z\":9},{\"x\":1,\"y\":0}],"
+        "\"labels\":[{\"text\":\"much too long\"},{\"text\":\"b\",\"style\":{\"weight\":700}}],"
+        "\"edges\":[{\"length\":1},{\"length\":1},{\"length\":1.5}]}";
+    BOOST_CHECK(decoder.decode(text,s));
+    BOOST_CHECK(s.name == "triangle");
+    BOOST_CHECK(s.closed);
+    BOOST_CHECK(s.sides == -1);
+    BOOST_CHECK(s.origin.x == 1 && s.origin.y == -2.5);
+    BOOST_CHECK(s.corners.size() == 3);
+    BOOST_CHECK(s.corners[1].x == 0 && s.corners[1].y == 1);
+    BOOST_CHECK(s.nlabels == 2);
+    BOOST_CHECK(std::strcmp(s.labels[0].text,"much to") == 0);
+    BOOST_CHECK(s.labels[0].weight == 400);
+    BOOST_CHECK(std::strcmp(s.labels[1].text,"b") == 0 && s.labels[1].weight == 700);
+    BOOST_CHECK(s.perimeter == 3.5);
+
+    // everything from the last text is reset
+    BOOST_CHECK(decoder.decode(std::string("{\"type\":\"shape\",\"meta\":{\"name\":\"dot\"},\"sides\":0}"),s));
+    BOOST_CHECK(s.name == "dot" && !s.closed && s.sides == 0);
+    BOOST_CHECK(s.corners.empty() && s.nlabels == 0 && s.perimeter == 0);
+}
+
+BOOST_AUTO_TEST_CASE(test_struct_decoder_mismatch)
+{
+    struct_decoder<shape> decoder;
+    shape s;
+    // not the matched type
+    BOOST_CHECK(!decoder.decode(std::string("{\"type\":\"line\",\"meta\":{\"name\":\"a\"}}"),s));
+    // no type, no name
+    BOOST_CHECK(!decoder.decode(std::string("{\"meta\":{\"name\":\"a\"}}"),s));
+    BOOST_CHECK(!decoder.decode(std::string("{\"type\":\"shape\"}"),s));
+    // a required member of an element
+    BOOST_CHECK(!decoder.decode(std::string("{\"type\":\"shape\",\"meta\":{\"name\":\"a\"},\"corners\":[{\"x\":1}]}"),s));
+    BOOST_CHECK(!decoder.decode(std::string("{\"type\":\"shape\",\"meta\":{\"name\":\"a\"},\"edges\":[{}]}"),s));
+    // values of the wrong type
+    BOOST_CHECK(!decoder.decode(std::string("{\"type\":\"shape\",\"meta\":{\"name\":1}}"),s));
+    BOOST_CHECK(!decoder.decode(std::string("{\"type\":\"shape\",\"meta\":{\"name\":\"a\"},\"sides\":\"3\"}"),s));
+    BOOST_CHECK(!decoder.decode(std::string("{\"type\":\"shape\",\"meta\":{\"name\":\"a\"},\"origin\":[]}"),s));
+    BOOST_CHECK(!decoder.decode(std::string("{\"type\":\"shape\",\"meta\":{\"name\":\"a\"},\"corners\":[1]}"),s));
+    BOOST_CHECK(!decoder.decode(std::string("[]"),s));
+    // more labels than fit
+    BOOST_CHECK(!decoder.decode(std::string("{\"type\":\"shape\",\"meta\":{\"name\":\"a\"},\"labels\":[{},{},{}]}"),s));
+    // null is as good as missing
+    BOOST_CHECK(decoder.decode(std::string("{\"type\":\"shape\",\"meta\":{\"name\":\"a\",\"closed\":null},\"sides\":null}"),s));
+    BOOST_CHECK(s.sides == -1 && !s.closed);
+
+    // text that is not json throws, and the decoder is still usable after
+    BOOST_CHECK_THROW(decoder.decode(std::string("{\"type\":\"shape\",\"edges\":[{\"length\":1}"),s),jsoncons::json_exception);
+    BOOST_CHECK(decoder.decode(std::string("{\"type\":\"shape\",\"meta\":{\"name\":\"a\"},\"edges\":[{\"length\":2}]}"),s));
+    BOOST_CHECK(s.perimeter == 2);
+}
@@ -0,0 +1,75 @@
+#include "latency.h"
+#include "logger.h"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+
+void latency_histogram::reset()
+{
+  for (auto& c: counts)
+    c = 0;
+  n = maxval = 0;
+}
+
+uint64_t latency_histogram::bucket_top(int b)
+{
+  if (b < SUB)
+    return b;
+  int shift = b / SUB - 1;
+  uint64_t sub = b % SUB;
+  // the largest value that maps to b
+  return (((uint64_t)SUB | sub) << shift) + ((uint64_t)1 << shift) - 1;
+}
+
+uint64_t latency_histogram::percentile(double p) const
+{
+  if (n == 0)
+    return 0;
+  uint64_t rank = std::max<uint64_t>(1, std::ceil(p * n));
+  uint64_t seen = 0;
+  for (int b = 0; b < NBUCKETS; b++) {
+    seen += counts[b];
+    if (seen >= rank)
+      return std::min(bucket_top(b), maxval);
+  }
+  return maxval;
+}
+
+void tick_latency::report(const std::string& filename) const
+{
+  struct { const char* name; const latency_histogram* h; } stages[] = {
+    { "wait", &wait }, { "parse", &parse }, { "react", &react }, { "send", &send }, { "total", &total }
+  };
+
+  LOG_INFO(logging::OUT) << "latency over " << total.count() << " messages, "
+    << late << " replies late, microseconds:";
+  for (auto& s: stages) {
+    LOG_INFO(logging::OUT) << "  " << s.name
+      << " p50 " << s.h->percentile(0.5) / 1e3
+      << " p99 " << s.h->percentile(0.99) / 1e3
+      << " p999 " << s.h->percentile(0.999) / 1e3
+      << " max " << s.h->max() / 1e3;
+  }
+
+  // one object per line, a line per game
+  std::ofstream out(filename, std::ios::app);
+  out << "{\"messages\":" << total.count() << ",\"late\":" << late;
+  for (auto& s: stages) {
+    out << ",\"" << s.name << "\":{\"count\":" << s.h->count()
+      << ",\"p50_ns\":" << s.h->percentile(0.5)
+      << ",\"p99_ns\":" << s.h->percentile(0.99)
+      << ",\"p999_ns\":" << s.h->percentile(0.999)
+      << ",\"max_ns\":" << s.h->max() << "}";
+  }
+  out << "}" << std::endl;
+}
+
+void tick_latency::reset()
+{
+  wait.reset();
+  parse.reset();
+  react.reset();
+  send.reset();
+  total.reset();
+  late = 0;
+}
@@ -0,0 +1,75 @@
+#ifndef LATENCY_H
+#define LATENCY_H
+
+#include <cstdint>
+#include <string>
+#include <chrono>
+
+// counts of nanosecond durations in log-linear buckets: values below 32 get
+// a bucket each, above that every power of two is split in 32, so any
+// percentile is within about 3% of the truth. recording is a few shifts and
+// an increment.
+class latency_histogram
+{
+public:
+  latency_histogram() { reset(); }
+
+  void record(uint64_t ns)
+  {
+    counts[bucket(ns)]++;
+    n++;
+    if (ns > maxval)
+      maxval = ns;
+  }
+
+  void reset();
+
+  uint64_t count() const { return n; }
+  uint64_t max() const { return maxval; }
+  // upper edge of the bucket holding the p quantile, 0 <= p <= 1
+  uint64_t percentile(double p) const;
+
+private:
+  static const int SUB_BITS = 5;
+  static const int SUB = 1 << SUB_BITS;
+  static const int NBUCKETS = (64 - SUB_BITS + 1) * SUB;
+
+  static int bucket(uint64_t v)
+  {
+    if (v < (uint64_t)SUB)
+      return v;
+    int e = 63 - __builtin_clzll(v);
+    int shift = e - SUB_BITS;
+    return (shift + 1) * SUB + ((v >> shift) & (SUB - 1));
+  }
+  static uint64_t bucket_top(int b);
+
+  uint64_t counts[NBUCKETS];
+  uint64_t n, maxval;
+};
+
+// where the time of each message goes in main's run() loop
+struct tick_latency
+{
+  typedef std::chrono::steady_clock clock;
+
+  latency_histogram wait; // blocked on the socket
+  latency_histogram parse; // carPositions decoder or the json tree
+  latency_histogram react; // game_logic
+  latency_histogram send;
+  latency_histogram total; // from having the line to the reply sent
+  uint64_t late; // replies sent after the next tick was already here
+
+  tick_latency() : late(0) {}
+
+  static uint64_t ns(clock::time_point from, clock::time_point to)
+  {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(to - from).count();
+  }
+
+  // a line per stage to the log, one json object to the end of filename
+  void report(const std::string& filename) const;
+  void reset();
+};
+
+#endif
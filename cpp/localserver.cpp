@@ -0,0 +1,273 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <thread>
+#include <algorithm>
+#include <boost/asio.hpp>
+#include <jsoncons/json.hpp>
+#include "race_sim.h"
+#include "protocol.h"
+
+using boost::asio::ip::tcp;
+typedef std::chrono::steady_clock clock_type;
+
+// one connected bot, speaking the same newline-delimited json as
+// hwo_connection on the other end
+struct bot_client
+{
+  bot_client(boost::asio::io_service& io_service) : socket(io_service), car(-1), pending(0) {}
+
+  tcp::socket socket;
+  boost::asio::streambuf buf;
+  int car;
+
+  // replies still expected for the latest tick and when it went out
+  int pending;
+  clock_type::time_point sent_at;
+
+  void send(const race_sim::msg_ptrs& msgs)
+  {
+    std::string out;
+    for (const jsoncons::json* m: msgs) {
+      out += m->to_string();
+      out += '\n';
+    }
+    boost::asio::write(socket, boost::asio::buffer(out));
+  }
+
+  void send(const jsoncons::json& msg)
+  {
+    send(race_sim::msg_ptrs{ &msg });
+  }
+
+  jsoncons::json receive()
+  {
+    auto len = boost::asio::read_until(socket, buf, "\n");
+    return take_line(len);
+  }
+
+  // a whole line if one has arrived, without blocking
+  bool try_receive(jsoncons::json& msg)
+  {
+    auto data = buf.data();
+    auto begin = boost::asio::buffers_begin(data), end = boost::asio::buffers_end(data);
+    auto nl = std::find(begin, end, '\n');
+    if (nl == end) {
+      size_t avail = socket.available();
+      if (avail == 0)
+        return false;
+      buf.commit(socket.read_some(buf.prepare(avail)));
+      return try_receive(msg);
+    }
+    msg = take_line(nl - begin + 1);
+    return true;
+  }
+
+private:
+  jsoncons::json take_line(size_t len)
+  {
+    auto data = buf.data();
+    std::string line(boost::asio::buffers_begin(data), boost::asio::buffers_begin(data) + len);
+    buf.consume(len);
+    return jsoncons::json::parse_string(line);
+  }
+};
+
+// every message with a tick wants exactly one reply except the turbo
+// notifications, the same rule game_logic::react follows
+int replies_expected(const race_sim::msg_ptrs& msgs)
+{
+  int n = 0;
+  for (const jsoncons::json* m: msgs) {
+    if (!m->has_member("gameTick"))
+      continue;
+    if (hwo_protocol::needs_reply(hwo_protocol::parse_msg_type(*m)))
+      n++;
+  }
+  return n;
+}
+
+class local_server
+{
+public:
+  local_server(const std::string& port, const jsoncons::json& track, const sim_config& config, double tickrate)
+    : acceptor(io_service, tcp::endpoint(tcp::v4(), std::stoi(port))),
+      sim(track, config),
+      tickrate(tickrate),
+      late(0)
+  {
+  }
+
+  void accept_bots();
+  void race();
+  void report(std::ostream& os);
+
+private:
+  void send_tick(const race_sim::msg_ptrs& msgs);
+  void handle(bot_client& bot, const jsoncons::json& reply);
+
+  boost::asio::io_service io_service;
+  tcp::acceptor acceptor;
+  std::vector<std::unique_ptr<bot_client>> bots;
+  race_sim sim;
+  double tickrate; // ticks per second, 0 to go as fast as the bots reply
+  std::vector<double> latencies; // microseconds from positions to reply
+  int late; // replies that came only after the next tick was sent
+  double racetime;
+};
+
+void local_server::accept_bots()
+{
+  static const char* colors[] = { "red", "blue", "green", "yellow", "orange", "purple", "pink", "black" };
+  int carcount = 1;
+
+  while ((int)bots.size() < carcount) {
+    std::unique_ptr<bot_client> bot(new bot_client(io_service));
+    acceptor.accept(bot->socket);
+    bot->socket.set_option(tcp::no_delay(true));
+
+    jsoncons::json msg = bot->receive();
+    const auto& msg_type = msg["msgType"].as<std::string>();
+    const auto& data = msg["data"];
+    std::string name;
+    if (msg_type == "join") {
+      name = data["name"].as<std::string>();
+    } else if (msg_type == "createRace" || msg_type == "joinRace") {
+      name = data["botId"]["name"].as<std::string>();
+      if (bots.empty())
+        carcount = std::min(data["carCount"].as<int>(), 8);
+    } else {
+      std::cout << "Expected join, got " << msg_type << std::endl;
+      continue;
+    }
+    std::cout << "Bot " << name << " joined as " << colors[bots.size()] << std::endl;
+
+    bot->car = sim.add_car(name, colors[bots.size()]);
+    bot->send(msg); // the server acknowledges joins by echoing them
+    bots.push_back(std::move(bot));
+  }
+
+  for (auto& bot: bots)
+    bot->send(sim.your_car(bot->car));
+}
+
+void local_server::send_tick(const race_sim::msg_ptrs& msgs)
+{
+  int expected = replies_expected(msgs);
+  for (auto& bot: bots) {
+    if (bot->pending > 0)
+      late++;
+    bot->send(msgs);
+    bot->pending = expected;
+    bot->sent_at = clock_type::now();
+  }
+}
+
+void local_server::handle(bot_client& bot, const jsoncons::json& reply)
+{
+  sim.apply(bot.car, reply);
+  if (bot.pending > 0 && --bot.pending == 0) {
+    auto took = clock_type::now() - bot.sent_at;
+    latencies.push_back(std::chrono::duration<double, std::micro>(took).count());
+  }
+}
+
+void local_server::race()
+{
+  auto start = clock_type::now();
+  auto next = start;
+  auto interval = std::chrono::duration_cast<clock_type::duration>(
+      std::chrono::duration<double>(tickrate > 0 ? 1.0 / tickrate : 0.0));
+
+  send_tick(sim.start());
+  while (!sim.finished()) {
+    if (tickrate > 0) {
+      // fixed rate like the real server; take whatever arrives in time
+      next += interval;
+      while (clock_type::now() < next) {
+        jsoncons::json reply;
+        bool any = false;
+        for (auto& bot: bots) {
+          while (bot->try_receive(reply)) {
+            handle(*bot, reply);
+            any = true;
+          }
+        }
+        if (!any)
+          std::this_thread::sleep_for(std::chrono::microseconds(20));
+      }
+    } else {
+      for (auto& bot: bots)
+        while (bot->pending > 0)
+          handle(*bot, bot->receive());
+    }
+    send_tick(sim.step());
+  }
+  racetime = std::chrono::duration<double>(clock_type::now() - start).count();
+
+  // closing with replies to the last tick still unread would reset the
+  // connection; let the bots see eof first and drain what they send
+  for (auto& bot: bots) {
+    boost::system::error_code error;
+    bot->socket.shutdown(tcp::socket::shutdown_send, error);
+    while (!error)
+      boost::asio::read(bot->socket, bot->buf, boost::asio::transfer_at_least(1), error);
+    bot->socket.close();
+  }
+}
+
+void local_server::report(std::ostream& os)
+{
+  std::sort(latencies.begin(), latencies.end());
+  auto pct = [&](double p) {
+    return latencies.empty() ? 0.0 : latencies[std::min(latencies.size() - 1, (size_t)(p * latencies.size()))];
+  };
+
+  for (int i = 0; i < sim.ncars(); i++) {
+    const sim_car& c = sim.car(i);
+    os << c.name << " (" << c.color << "): laps " << c.lap_ticks.size() << ", crashes " << c.crashes << ", lap ticks";
+    for (int t: c.lap_ticks)
+      os << " " << t;
+    os << std::endl;
+  }
+  os << sim.tick() << " ticks in " << racetime << " s: " << sim.tick() / racetime << " ticks/s" << std::endl;
+  os << "reply latency us: p50 " << pct(0.5)
+    << " p99 " << pct(0.99)
+    << " max " << (latencies.empty() ? 0.0 : latencies.back())
+    << ", late replies " << late << std::endl;
+}
+
+int main(int argc, const char* argv[])
+{
+  if (argc < 2 || argc > 5)
+  {
+    std::cerr << "Usage: ./localserver trackfile [port] [tickrate] [laps]" << std::endl;
+    std::cerr << "tickrate is ticks per second, 0 (the default) ticks as soon as all bots have replied" << std::endl;
+    return 1;
+  }
+
+  try
+  {
+    const std::string trackfile(argv[1]);
+    const std::string port(argc >= 3 ? argv[2] : "8091");
+    double tickrate = argc >= 4 ? std::stod(argv[3]) : 0.0;
+    sim_config config;
+    if (argc >= 5)
+      config.laps = std::stoi(argv[4]);
+
+    std::cout << "Track: " << trackfile << ", port: " << port << ", tickrate: " << tickrate << ", laps: " << config.laps << std::endl;
+
+    local_server server(port, race_sim::load_track(trackfile), config, tickrate);
+    server.accept_bots();
+    server.race();
+    server.report(std::cout);
+  }
+  catch (const std::exception& e)
+  {
+    std::cerr << e.what() << std::endl;
+    return 2;
+  }
+
+  return 0;
+}
@@ -0,0 +1,241 @@
+#include "logger.h"
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+namespace logging {
+
+namespace {
+
+const size_t RING_SIZE = 1 << 22; // bytes, a power of two
+const uint16_t PADDING = 0xffff; // skip to the start of the ring
+
+// records start at 8 byte boundaries with this
+struct header {
+  uint32_t size; // including the header and alignment
+  uint32_t len; // of the encoded arguments after the header
+  uint16_t sink;
+  uint16_t unused;
+};
+
+class logger
+{
+public:
+  logger();
+  ~logger();
+
+  bool push(int sink, const char* data, size_t len);
+  void flush();
+
+  std::atomic<std::ostream*> sinks[MAX_SINKS];
+  std::atomic<unsigned long> dropped[MAX_SINKS];
+
+private:
+  void run();
+  void write(std::ostream& os, const char* p, const char* end);
+
+  std::vector<char> ring;
+  // total bytes ever written and read; the ring offset is these mod RING_SIZE
+  std::atomic<uint64_t> head, tail;
+  std::atomic<uint64_t> flushed; // everything before this is on disk
+  std::atomic<bool> stop;
+  std::thread writer;
+};
+
+logger::logger()
+  : ring(RING_SIZE), head(0), tail(0), flushed(0), stop(false)
+{
+  for (int i = 0; i < MAX_SINKS; i++) {
+    sinks[i] = nullptr;
+    dropped[i] = 0;
+  }
+  sinks[OUT] = &std::cout;
+  sinks[ERR] = &std::cerr;
+  writer = std::thread(&logger::run, this);
+}
+
+logger::~logger()
+{
+  stop = true;
+  writer.join();
+  for (int i = 0; i < MAX_SINKS; i++)
+    if (dropped[i])
+      std::cerr << "logging: dropped " << dropped[i] << " records for sink " << i << std::endl;
+}
+
+bool logger::push(int sink, const char* data, size_t len)
+{
+  size_t size = (sizeof(header) + len + 7) & ~size_t(7);
+  uint64_t h = head.load(std::memory_order_relaxed);
+  size_t at = h & (RING_SIZE - 1);
+  // records never wrap around; pad the end and start over
+  size_t pad = at + size > RING_SIZE ? RING_SIZE - at : 0;
+
+  if (h + pad + size - tail.load(std::memory_order_acquire) > RING_SIZE) {
+    dropped[sink].fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+
+  if (pad) {
+    header ph { (uint32_t)pad, 0, PADDING, 0 };
+    std::memcpy(&ring[at], &ph, sizeof ph);
+    h += pad;
+    at = 0;
+  }
+  header rh { (uint32_t)size, (uint32_t)len, (uint16_t)sink, 0 };
+  std::memcpy(&ring[at], &rh, sizeof rh);
+  std::memcpy(&ring[at + sizeof rh], data, len);
+  head.store(h + size, std::memory_order_release);
+  return true;
+}
+
+void logger::flush()
+{
+  uint64_t h = head.load(std::memory_order_relaxed);
+  while (flushed.load(std::memory_order_acquire) < h)
+    std::this_thread::sleep_for(std::chrono::microseconds(50));
+}
+
+void logger::run()
+{
+  bool dirty[MAX_SINKS] = {};
+  for (;;) {
+    bool stopping = stop.load(std::memory_order_acquire);
+    uint64_t h = head.load(std::memory_order_acquire);
+    uint64_t t = tail.load(std::memory_order_relaxed);
+
+    while (t != h) {
+      const char* rec = &ring[t & (RING_SIZE - 1)];
+      header rh;
+      std::memcpy(&rh, rec, sizeof rh);
+      if (rh.sink != PADDING) {
+        std::ostream* os = sinks[rh.sink].load(std::memory_order_acquire);
+        if (os) {
+          write(*os, rec + sizeof rh, rec + sizeof rh + rh.len);
+          dirty[rh.sink] = true;
+        }
+      }
+      t += rh.size;
+      tail.store(t, std::memory_order_release);
+    }
+
+    // a batch is done; one flush per stream instead of one per line
+    for (int i = 0; i < MAX_SINKS; i++) {
+      if (dirty[i]) {
+        std::ostream* os = sinks[i].load(std::memory_order_acquire);
+        if (os)
+          os->flush();
+        dirty[i] = false;
+      }
+    }
+    flushed.store(h, std::memory_order_release);
+
+    if (stopping)
+      break;
+    if (head.load(std::memory_order_acquire) == h)
+      std::this_thread::sleep_for(std::chrono::microseconds(500));
+  }
+}
+
+void logger::write(std::ostream& os, const char* p, const char* end)
+{
+  while (p < end) {
+    char tag = *p++;
+    switch (tag) {
+      case 's': {
+        uint32_t n;
+        std::memcpy(&n, p, sizeof n);
+        os.write(p + sizeof n, n);
+        p += sizeof n + n;
+        break;
+      }
+      case 'i': {
+        long long v;
+        std::memcpy(&v, p, sizeof v);
+        os << v;
+        p += sizeof v;
+        break;
+      }
+      case 'u': {
+        unsigned long long v;
+        std::memcpy(&v, p, sizeof v);
+        os << v;
+        p += sizeof v;
+        break;
+      }
+      case 'd': {
+        double v;
+        std::memcpy(&v, p, sizeof v);
+        os << v;
+        p += sizeof v;
+        break;
+      }
+      case 'c':
+        os << *p++;
+        break;
+      case 'b':
+        os << (bool)*p++;
+        break;
+      default:
+        p = end;
+        break;
+    }
+  }
+  os << '\n';
+}
+
+logger& instance()
+{
+  static logger l;
+  return l;
+}
+
+}
+
+bool enabled = true;
+
+void disable()
+{
+  enabled = false;
+}
+
+int add_sink(std::ostream& os)
+{
+  logger& l = instance();
+  for (int i = 0; i < MAX_SINKS; i++) {
+    std::ostream* expected = nullptr;
+    if (l.sinks[i].compare_exchange_strong(expected, &os))
+      return i;
+  }
+  return -1;
+}
+
+void remove_sink(int sink)
+{
+  if (sink < 0)
+    return;
+  logger& l = instance();
+  l.flush();
+  l.sinks[sink] = nullptr;
+}
+
+void flush()
+{
+  instance().flush();
+}
+
+unsigned long dropped(int sink)
+{
+  return instance().dropped[sink];
+}
+
+void line::commit()
+{
+  if (!enabled || sink < 0 || sink >= MAX_SINKS)
+    return;
+  instance().push(sink, spilled ? spill.data() : small, len);
+}
+
+}
@@ -0,0 +1,160 @@
+#ifndef LOGGER_H
+#define LOGGER_H
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <sstream>
+#include <ostream>
+#include <type_traits>
+
+// levels below LOG_LEVEL compile to nothing, e.g. make LOG_LEVEL=LOG_LEVEL_INFO
+#define LOG_LEVEL_DEBUG 0
+#define LOG_LEVEL_INFO  1
+#define LOG_LEVEL_WARN  2
+#define LOG_LEVEL_ERROR 3
+#define LOG_LEVEL_NONE  4
+
+#ifndef LOG_LEVEL
+#define LOG_LEVEL LOG_LEVEL_DEBUG
+#endif
+
+// one record per statement, ended with a newline by the writer thread (brace
+// it as the body of an if):
+//   LOG_DEBUG(logging::OUT) << "msg tick " << tick;
+// the arguments are not evaluated at all when the level is compiled out
+#define LOG_AT(level, sink) if ((level) < LOG_LEVEL || !logging::enabled) {} else logging::line(sink)
+#define LOG_DEBUG(sink) LOG_AT(LOG_LEVEL_DEBUG, sink)
+#define LOG_INFO(sink)  LOG_AT(LOG_LEVEL_INFO, sink)
+#define LOG_WARN(sink)  LOG_AT(LOG_LEVEL_WARN, sink)
+#define LOG_ERROR(sink) LOG_AT(LOG_LEVEL_ERROR, sink)
+
+// logging that stays off the caller's thread. records are binary encoded
+// arguments pushed to a single producer single consumer ring; a background
+// thread formats them with the usual operator<< into the sink streams and
+// flushes once the ring runs empty. when the ring is full the record is
+// dropped and counted instead of waiting.
+//
+// only one thread may log (the bot is single threaded). programs that run
+// game_logic on several threads call disable() first.
+namespace logging {
+
+// true until disable()
+extern bool enabled;
+// from now on drop every record without formatting it; call before
+// starting any threads
+void disable();
+
+// std::cout and std::cerr; add_sink gives more
+enum { OUT = 0, ERR = 1, MAX_SINKS = 8 };
+
+// the stream must stay alive until remove_sink
+int add_sink(std::ostream& os);
+// flushes pending records first
+void remove_sink(int sink);
+// returns once everything logged so far has been written and flushed
+void flush();
+// records lost to a full ring, per sink
+unsigned long dropped(int sink);
+
+// a string that is not nul terminated
+struct text {
+  const char* p;
+  size_t n;
+  text(const char* p, size_t n) : p(p), n(n) {}
+};
+
+class line
+{
+public:
+  explicit line(int sink) : sink(sink), len(0), spilled(false) {}
+  ~line() { commit(); }
+
+  line& operator<<(const std::string& s) { put_str(s.data(), s.size()); return *this; }
+  line& operator<<(const char* s) { put_str(s, std::strlen(s)); return *this; }
+  line& operator<<(text t) { put_str(t.p, t.n); return *this; }
+  line& operator<<(char c) { put('c', &c, 1); return *this; }
+  line& operator<<(bool b) { put('b', &b, 1); return *this; }
+  line& operator<<(double d) { put('d', &d, sizeof d); return *this; }
+  line& operator<<(float f) { return *this << (double)f; }
+
+  template <class T>
+  typename std::enable_if<std::is_integral<T>::value && std::is_signed<T>::value, line&>::type
+  operator<<(T x) { long long v = x; put('i', &v, sizeof v); return *this; }
+
+  template <class T>
+  typename std::enable_if<std::is_integral<T>::value && std::is_unsigned<T>::value, line&>::type
+  operator<<(T x) { unsigned long long v = x; put('u', &v, sizeof v); return *this; }
+
+  // anything else with an operator<< is formatted here, off the fast path
+  template <class T>
+  typename std::enable_if<!std::is_arithmetic<T>::value, line&>::type
+  operator<<(const T& x)
+  {
+    std::ostringstream os;
+    os << x;
+    return *this << os.str();
+  }
+
+private:
+  line(const line&);
+  line& operator=(const line&);
+
+  void put(char tag, const void* p, size_t n)
+  {
+    char* dst = reserve(1 + n);
+    *dst = tag;
+    std::memcpy(dst + 1, p, n);
+  }
+
+  void put_str(const char* s, size_t n)
+  {
+    uint32_t n32 = n;
+    char* dst = reserve(1 + sizeof n32 + n);
+    *dst = 's';
+    std::memcpy(dst + 1, &n32, sizeof n32);
+    std::memcpy(dst + 1 + sizeof n32, s, n);
+  }
+
+  char* reserve(size_t n)
+  {
+    if (len + n > sizeof small && !spilled) {
+      spill.assign(small, len);
+      spilled = true;
+    }
+    size_t at = len;
+    len += n;
+    if (spilled) {
+      spill.resize(len);
+      return &spill[at];
+    }
+    return small + at;
+  }
+
+  void commit();
+
+  int sink;
+  size_t len;
+  char small[1024];
+  bool spilled;
+  std::string spill; // for the rare records that do not fit in small
+};
+
+// a line built over several statements; null_line when the level is
+// compiled out:
+//   logging::line_at<LOG_LEVEL_DEBUG> log(logging::OUT);
+//   for (...) log << x;
+class null_line
+{
+public:
+  explicit null_line(int sink) {}
+  template <class T>
+  null_line& operator<<(const T&) { return *this; }
+};
+
+template <int Level>
+using line_at = typename std::conditional<(Level >= LOG_LEVEL), line, null_line>::type;
+
+}
+
+#endif
@@ -4,6 +4,10 @@
 #include "protocol.h"
 #include "connection.h"
 #include "game_logic.h"
+#include "inbox.h"
+#include "logger.h"
+#include "latency.h"
+#include <algorithm>
 
 using namespace hwo_protocol;
 
@@ -11,21 +15,34 @@ void run(hwo_connection& connection, const std::string& name,
     const std::string& key, const std::string& track = "", const std::string& pwd = "", const std::string& carcount = "")
 {
   game_logic game;
+  inbox in;
+  // named like the rawlog; ./telemetry2txt turns it into plotlog.gnuplot input
+  telemetry_recorder telemetry("telemetry" + track + ".bin");
+  game.set_telemetry(&telemetry);
+  game.set_track_cache(".");
+  outbox hello;
   if (track == "")
-    connection.send_requests({ make_join(name, key) });
+    hello.add(make_join(name, key));
   else if (pwd == "")
-    connection.send_requests({ make_create_single(name, key, track) });
+    hello.add(make_create_single(name, key, track));
   else
-    connection.send_requests({ make_join_race(name, key, track, pwd, carcount) });
+    hello.add(make_join_race(name, key, track, pwd, carcount));
+  connection.send_requests(hello);
 
+  tick_latency latency;
+  const std::string latency_file = "latency" + track + ".json";
+  int replied_tick = -1; // of the latest reply
+  size_t ahead = 0; // bytes that had arrived already when it was sent
   for (;;)
   {
+    auto t0 = tick_latency::clock::now();
     boost::system::error_code error;
-    auto response = connection.receive_response(error);
+    hwo_connection::raw_line line = connection.receive_line(error);
+    auto t1 = tick_latency::clock::now();
 
     if (error == boost::asio::error::eof)
     {
-      std::cout << "Connection closed" << std::endl;
+      LOG_INFO(logging::OUT) << "Connection closed";
       break;
     }
     else if (error)
@@ -33,7 +50,44 @@ void run(hwo_connection& connection, const std::string& name,
       throw boost::system::system_error(error);
     }
 
-    connection.send_requests(game.react(response));
+    in.decode(line.data, line.size);
+    auto t2 = tick_latency::clock::now();
+    msg_type type = in.type();
+    int tick = in.tick();
+
+    const game_logic::msg_vector& replies = in.react(game);
+    auto t3 = tick_latency::clock::now();
+    // before sending; on localhost the answer to this reply can come back
+    // before send_requests even returns
+    size_t unread = connection.pending_bytes();
+    connection.send_requests(replies);
+    auto t4 = tick_latency::clock::now();
+    in.release();
+
+    // a later tick that was already waiting when we answered the last one
+    if (ahead > 0) {
+      ahead -= std::min(ahead, line.size);
+      if (replied_tick != -1 && tick > replied_tick) {
+        latency.late++;
+        replied_tick = -1;
+      }
+    }
+    if (tick != -1 && !replies.empty()) {
+      replied_tick = tick;
+      ahead = unread;
+    }
+
+    latency.wait.record(tick_latency::ns(t0, t1));
+    latency.parse.record(tick_latency::ns(t1, t2));
+    latency.react.record(tick_latency::ns(t2, t3));
+    latency.send.record(tick_latency::ns(t3, t4));
+    latency.total.record(tick_latency::ns(t1, t4));
+
+    if (type == MSG_GAME_END) {
+      latency.report(latency_file);
+      latency.reset();
+      connection.flush_rawlog();
+    }
   }
 }
 
@@ -55,13 +109,14 @@ int main(int argc, const char* argv[])
     const std::string track(argc >= 6 ? argv[5] : "");
     const std::string pwd(argc >= 7 ? argv[6] : "");
     const std::string carcount(argc >= 8 ? argv[7] : "");
-    std::cout << "Host: " << host << ", port: " << port << ", name: " << name << ", key: " << key << ", track: " << track << ", pwd: " << pwd << ", count: " << carcount << std::endl;
+    LOG_INFO(logging::OUT) << "Host: " << host << ", port: " << port << ", name: " << name << ", key: " << key << ", track: " << track << ", pwd: " << pwd << ", count: " << carcount;
 
     hwo_connection connection(host, port, track);
     run(connection, name, key, track, pwd, carcount);
   }
   catch (const std::exception& e)
   {
+    logging::flush();
     std::cerr << e.what() << std::endl;
     return 2;
   }
@@ -1,4 +1,63 @@
 #include "player.h"
+#include "logger.h"
+#include <cmath>
+#include <algorithm>
+
+namespace {
+
+struct config_field {
+  const char* name;
+  double player_config::* d;
+  int player_config::* i;
+};
+
+const config_field FIELDS[] = {
+  { "bend_speed", &player_config::bend_speed, nullptr },
+  { "coef_ticks", nullptr, &player_config::coef_ticks },
+  { "turbo_lead", nullptr, &player_config::turbo_lead },
+  { "crash_tighten", &player_config::crash_tighten, nullptr },
+  { "relax_step", &player_config::relax_step, nullptr },
+  { "calm_angle", &player_config::calm_angle, nullptr },
+};
+
+const config_field* find_field(const std::string& name) {
+  for (const config_field& f: FIELDS)
+    if (name == f.name)
+      return &f;
+  return nullptr;
+}
+
+}
+
+bool player_config::set(const std::string& name, double value) {
+  const config_field* f = find_field(name);
+  if (!f)
+    return false;
+  if (f->d)
+    this->*f->d = value;
+  else
+    this->*f->i = (int)std::lround(value);
+  // a line needs two points
+  coef_ticks = std::max(coef_ticks, 2);
+  return true;
+}
+
+double player_config::get(const std::string& name) const {
+  const config_field* f = find_field(name);
+  if (!f)
+    return NAN;
+  return f->d ? this->*f->d : this->*f->i;
+}
+
+const std::vector<std::string>& player_config::names() {
+  static const std::vector<std::string> all = [] {
+    std::vector<std::string> v;
+    for (const config_field& f: FIELDS)
+      v.push_back(f.name);
+    return v;
+  }();
+  return all;
+}
 
 void Player::update(const CarPosition& now) {
   if (nticks == 0) {
@@ -10,36 +69,121 @@ void Player::update(const CarPosition& now) {
 
   curspeed = compute_travel(now);
   estimate_coefs(now);
+  learn_limits(now);
   prevspeed = curspeed;
   tottravel += curspeed;
 }
 
 void Player::estimate_coefs(const CarPosition& now) {
-  if (nticks == COEF_MEAS_TICKS) {
-    double initial_thrust = 1.0;
-    // start pos is not always 0; speed in tick delta units
-    double x1 = prevspeed;//prev.inPieceDistance;
-    double x2 = prevspeed+curspeed;//now.inPieceDistance;
-    // v1 = x1, as x0 = 0
-    double v2 = x2 - x1;
-
-    power = x1 / initial_thrust; // v += power * thrust, initially v zero so no drag
-    drag = (v2 - x1) / x1; // v2 = drag * v1 + accel, accel = increase in one step = x1
-    double max = power / (1 - drag);
-    std::cout << "COEF: p=" << power << " d=" << drag << " maxspd=" << max << std::endl;
+  // the model holds within a piece on one lane at a steady turbo; across
+  // pieces the travel depends on compute_travel's guess of lane lengths.
+  // standing still is a crash, not a tick at zero speed
+  bool clean = now.pieceIndex == prev.pieceIndex
+    && now.startLane == now.endLane && prev.startLane == prev.endLane
+    && turbofactor == prevturbo
+    && (prevspeed != 0.0 || curspeed != 0.0);
+  prevturbo = turbofactor;
+  if (!clean) {
+    coefs.skip();
+    return;
+  }
+  if (!coefs.add(prevspeed, curspeed, applied_throttle * turbofactor) || !coefs.ready())
+    return;
+
+  power = coefs.power;
+  drag = coefs.drag;
+  if (!profile.built()) {
+    if (coefs.accepted >= config.coef_ticks) {
+      LOG_INFO(logging::OUT) << "COEF: p=" << power << " d=" << drag << " maxspd=" << power / (1 - drag);
+      plan();
+    }
+  } else if (std::abs(drag - profile.drag) > REPLAN_SLOPE * (1 - profile.drag) && drag > 0.0 && drag < 1.0) {
+    // throttle_for_speed has the new coefs already; the braking curves
+    // only once drag has moved enough to matter
+    LOG_INFO(logging::OUT) << "COEF: p=" << power << " d=" << drag << " replan";
+    profile.set_drag(drag);
+  }
+}
+
+void Player::plan() {
+  if (!(drag > 0.0 && drag < 1.0))
+    return; // bogus measurement, braking would never end
+
+  if (!profile.built() || profile.index != index || profile.drag != drag) {
+    profile.build(index, drag, limits);
+  } else {
+    // same coefs, so only the bends whose limit changed need new curves
+    for (int i = 0; i < index->npieces; i++)
+      profile.set_limit(i, limits[i]);
   }
 }
 
+void Player::init_limits() {
+  int n = index->npieces;
+  limits.assign(n, INFINITY);
+  crashed_at.assign(n, INFINITY);
+  bend_of.assign(n, -1);
+  auto turn = [&](int i) { return index->bend[i] ? (track->track[i].angle > 0 ? 1 : -1) : 0; };
+  for (int i = 0; i < n; i++) {
+    if (!index->bend[i])
+      continue;
+    limits[i] = speed_for_bend(index->radius[i]);
+    // back to where the turn starts; a track that is one bend all round
+    // starts it at 0
+    int first = i;
+    for (int k = 1; k < n && turn((i - k + n) % n) == turn(i); k++)
+      first = (i - k + n) % n;
+    bend_of[i] = turn((first + n - 1) % n) == turn(i) ? 0 : first;
+  }
+}
+
+void Player::learn_limits(const CarPosition& now) {
+  // the angle peaks only after the exit, so a bend counts until the next
+  // one is entered
+  int bend = bend_of[now.pieceIndex];
+  if (bend >= 0 && bend_of[prev.pieceIndex] != bend) {
+    relax_bend();
+    cur_bend = bend;
+    bend_angle = 0.0;
+    bend_crashed = false;
+  }
+  bend_angle = std::max(bend_angle, std::abs(now.angle));
+}
+
+void Player::relax_bend() {
+  if (cur_bend < 0 || bend_crashed || bend_angle >= config.calm_angle)
+    return;
+  for (int i = cur_bend, k = 0; k < index->npieces && bend_of[i] == cur_bend; i = (i + 1) % index->npieces, k++)
+    set_bend_limit(i, std::max(limits[i], std::min(limits[i] * config.relax_step, crashed_at[i] * CRASH_MARGIN)));
+}
+
+void Player::on_crash() {
+  if (cur_bend < 0)
+    return; // not even in the first bend yet, nothing to blame
+  bend_crashed = true;
+  for (int i = cur_bend, k = 0; k < index->npieces && bend_of[i] == cur_bend; i = (i + 1) % index->npieces, k++) {
+    crashed_at[i] = std::min(crashed_at[i], limits[i]);
+    set_bend_limit(i, limits[i] * config.crash_tighten);
+  }
+  LOG_INFO(logging::OUT) << "CRASH: bend at " << cur_bend << " angle " << bend_angle
+    << ", limit now " << limits[cur_bend];
+}
+
+void Player::set_bend_limit(int piece, double limit) {
+  limits[piece] = limit;
+  // only the braking curve up to this piece changes
+  if (profile.built())
+    profile.set_limit(piece, limit);
+}
+
 double Player::compute_travel(const CarPosition& now) const {
   // TODO lane switching
-  double lanedist = track->lanedist[now.startLane];
-
   double travel;
   if (now.pieceIndex == prev.pieceIndex) {
     travel = now.inPieceDistance - prev.inPieceDistance;
   } else {
     // changed piece between ticks
-    double last_remaining = track->track[prev.pieceIndex].travel(lanedist) - prev.inPieceDistance;
+    double last_remaining = index->travel(now.startLane, prev.pieceIndex) - prev.inPieceDistance;
     double in_this = now.inPieceDistance;
     travel = last_remaining + in_this;
   }
@@ -65,57 +209,24 @@ int Player::best_turbo_start() const {
       this_start = i + 1;
     }
   }
-  return longest_start % n;
+  return ((longest_start - config.turbo_lead) % n + n) % n;
 }
 
 double Player::compute_throttle(const CarPosition& now) const {
 #if 0
   return throttle_for_speed((nticks / 200) * topspeed() / 10.0);
 #endif
-  // safest throttle based on all the future track.
-  // probably do not need to look ahead the whole track, but what the hell
-  double best_throttle = 1.0;
-  // track has >= 1 pieces for sure
-  for (size_t i = 0; i < track->track.size() - 1; i++) {
-    double thr = throttle_for_piece(now, i);
-    best_throttle = std::min(best_throttle, thr);
-  }
-  return best_throttle;
-}
-
-double Player::throttle_for_piece(const CarPosition& now, int lookahead) const {
-  int next = (now.pieceIndex + lookahead) % track->track.size();
-  // straights do not need braking
-  if (track->track[next].length != 0.0)
-    return 1.0;
-
-  double topspeed = speed_for_bend(track->track[next].radius);
-  if (lookahead == 0) // already in this bend
-    return throttle_for_speed(topspeed);
-
-  double dist_to_next = dist_to_piece(now, next);
-  int ticks = ticks_to_slow_down(curspeed, topspeed);
-  double brake_dist = brake_travel(curspeed, ticks);
-
-  if (dist_to_next > brake_dist)
+  // the profile has the braking curves of all the bends ahead already, so
+  // aim at the allowed speed where we are going to be on the next tick
+  if (!profile.built())
     return 1.0;
-  return 0.0;
+  double pos = index->position(now.startLane, now.pieceIndex, now.inPieceDistance);
+  return throttle_for_speed(profile.speed_at(now.startLane, pos + curspeed));
 }
 
 double Player::dist_to_piece(const CarPosition& now, int target) const {
-  if (now.pieceIndex == target)
-    return 0.0;
-
-  double lanedist = track->lanedist[now.startLane]; // close enough estimate to hold current lane
-  double dist = track->track[now.pieceIndex].travel(lanedist) - now.inPieceDistance;
-
-  int idx = (now.pieceIndex + 1) % track->track.size();
-  while (idx != target) {
-    dist += track->track[idx].travel(lanedist);
-    idx = (idx + 1) % track->track.size();
-  }
-
-  return dist;
+  // close enough estimate to hold current lane
+  return index->dist_to_piece(now.startLane, now.pieceIndex, now.inPieceDistance, target);
 }
 
 double Player::throttle_for_speed(double speed) const {
@@ -142,7 +253,7 @@ int Player::ticks_to_slow_down(double cur, double target) const {
 }
 
 double Player::speed_for_bend(double radius) const {
-  return 0.62 * std::sqrt(radius);
+  return config.bend_speed * std::sqrt(radius);
 }
 
 int Player::next_bend(int curridx) const {
@@ -2,9 +2,40 @@
 #define PLAYER_H
 
 #include "game_objs.h"
+#include "track_index.h"
+#include "velocity_profile.h"
+#include "coef_estimator.h"
+#include <string>
+#include <vector>
+
+// the hand tuned constants of the strategy, so that sweep can vary them
+struct player_config {
+  double bend_speed; // the limit in a bend is bend_speed * sqrt(radius)
+  int coef_ticks; // clean ticks fitted before the first plan, 2 or more
+  int turbo_lead; // pieces before the longest straight to fire the turbo
+  double crash_tighten; // a bend's limit is scaled by this after a crash in it
+  double relax_step; // and by this after a pass with the angle under calm_angle
+  double calm_angle; // degrees, well below where the car crashes
+
+  player_config()
+    : bend_speed(0.62), coef_ticks(2), turbo_lead(0),
+    crash_tighten(0.9), relax_step(1.02), calm_angle(30.0)
+  {}
+
+  // by the names of names(); false if there is no such one
+  bool set(const std::string& name, double value);
+  double get(const std::string& name) const;
+  static const std::vector<std::string>& names();
+};
 
 struct Player {
-  static const int COEF_MEAS_TICKS = 2;
+  // drag may drift this much of the braking rate 1 - drag before the
+  // braking curves are redone
+  static constexpr double REPLAN_SLOPE = 1e-3;
+  // a calm bend is relaxed up to this much of the lowest limit it crashed at
+  static constexpr double CRASH_MARGIN = 0.98;
+
+  player_config config;
   CarPosition prev;
   double tottravel;
   int nticks;
@@ -13,21 +44,26 @@ struct Player {
   double curspeed, prevspeed;
 
   const Track* track;
+  const TrackIndex* index;
 
 
-  Player(const Track* track) : prev{ "", "", 0.0, 0, 0.0, 0, 0 },
+  Player(const Track* track, const TrackIndex* index, const player_config& config = player_config())
+    : config(config), prev(),
     tottravel(0.0), nticks(0),
     power(0.0), drag(0.0), curspeed(0.0), prevspeed(0.0),
-    track(track)
+    track(track), index(index)
 
-    ,turbofactor(0.0)
-    {}
-  Player() : Player(nullptr) {}
+    ,turbofactor(1.0), prevturbo(1.0), applied_throttle(0.0),
+    cur_bend(-1), bend_angle(0.0), bend_crashed(false)
+    { if (index) init_limits(); }
+  Player() : Player(nullptr, nullptr) {}
+  // still at full throttle measuring, with no plan to go by
+  bool warming_up() const { return nticks < config.coef_ticks && !profile.built(); }
   double compute_throttle(const CarPosition& now) const;
-  double throttle_for_piece(const CarPosition& now, int lookahead) const;
   void update(const CarPosition& now);
   void endtick(const CarPosition& now);
   void estimate_coefs(const CarPosition& now);
+  void plan();
   double throttle_for_speed(double speed) const;
   double compute_travel(const CarPosition& now) const;
   double topspeed() const;
@@ -41,7 +77,34 @@ struct Player {
   void set_turbo(double factor);
   void reset_turbo();
 
+  void init_limits();
+  // the bend just driven gets a lower limit; game_logic calls this when
+  // this car crashes
+  void on_crash();
+  void learn_limits(const CarPosition& now);
+  void relax_bend();
+  void set_bend_limit(int piece, double limit);
+
   double turbofactor;
+  double prevturbo; // turbofactor as of the previous update
+
+  // the last throttle sent, which the server keeps applying until the
+  // next one; game_logic sets it
+  double applied_throttle;
+  // power and drag follow this on every clean tick
+  CoefEstimator coefs;
+
+  // per piece: the speed limit learned so far, infinite on straights, and
+  // the lowest one there has been a crash at
+  std::vector<double> limits, crashed_at;
+  // per piece: the first piece of the bend it is in, a run of pieces
+  // turning the same way; -1 on straights
+  std::vector<int> bend_of;
+  int cur_bend; // the last bend entered, until the next one
+  double bend_angle; // the largest |angle| since entering it
+  bool bend_crashed;
+
+  VelocityProfile profile;
 };
 
 #endif
@@ -0,0 +1,30 @@
+#ifndef POSITIONS_DECODER_H
+#define POSITIONS_DECODER_H
+
+#include "game_objs.h"
+#include <string>
+#include <jsoncons/struct_decoder.hpp>
+
+// reads carPositions lines straight into a CarPositions without building a
+// json tree, as laid out by json_fields<char, CarPositions>. everything is
+// reused between messages, so after the first few ticks decoding allocates
+// nothing. other messages (or carPositions with more than MAX_CARS cars or
+// missing fields) are rejected and should go through a jsoncons::json_parser
+// as before.
+class positions_decoder
+{
+public:
+  positions_decoder() : result() {}
+
+  // true if msg was a carPositions and positions() now holds it
+  bool decode(const char* msg, size_t len) { return decoder.decode(msg, len, result); }
+  bool decode(const std::string& msg) { return decode(msg.data(), msg.size()); }
+
+  const CarPositions& positions() const { return result; }
+
+private:
+  jsoncons::struct_decoder<CarPositions> decoder;
+  CarPositions result;
+};
+
+#endif
@@ -1,6 +1,8 @@
 #include "protocol.h"
 
 #include <sstream>
+#include <cmath>
+#include <cstring>
 namespace hwo_protocol
 {
 
@@ -65,3 +67,231 @@ namespace hwo_protocol
     return make_request("turbo", msg);
   }
 }  // namespace hwo_protocol
+
+namespace hwo_protocol
+{
+  namespace
+  {
+    const char* const MSG_TYPE_NAMES[MSG_TYPE_COUNT] = {
+      "",
+      "join", "createRace", "joinRace", "yourCar",
+      "gameInit", "gameStart", "carPositions",
+      "crash", "spawn", "lapFinished", "dnf", "finish",
+      "gameEnd", "tournamentEnd", "error",
+      "turboAvailable", "turboStart", "turboEnd"
+    };
+  }
+
+  msg_type parse_msg_type(const char* s, size_t n)
+  {
+    if (n == 0)
+      return MSG_UNKNOWN;
+    msg_type t = MSG_UNKNOWN;
+    switch (n) {
+    case 3: t = MSG_DNF; break;
+    case 4: t = MSG_JOIN; break;
+    case 5: t = s[0] == 'c' ? MSG_CRASH : s[0] == 's' ? MSG_SPAWN : MSG_ERROR; break;
+    case 6: t = MSG_FINISH; break;
+    case 7: t = s[0] == 'y' ? MSG_YOUR_CAR : MSG_GAME_END; break;
+    case 8: t = s[0] == 'g' ? MSG_GAME_INIT : s[0] == 't' ? MSG_TURBO_END : MSG_JOIN_RACE; break;
+    case 9: t = MSG_GAME_START; break;
+    case 10: t = s[0] == 't' ? MSG_TURBO_START : MSG_CREATE_RACE; break;
+    case 11: t = MSG_LAP_FINISHED; break;
+    case 12: t = MSG_CAR_POSITIONS; break;
+    case 13: t = MSG_TOURNAMENT_END; break;
+    case 14: t = MSG_TURBO_AVAILABLE; break;
+    default: return MSG_UNKNOWN;
+    }
+    return std::memcmp(s, MSG_TYPE_NAMES[t], n) == 0 ? t : MSG_UNKNOWN;
+  }
+
+  template <class Json>
+  msg_type parse_msg_type_of(const Json& msg)
+  {
+    if (!msg.is_object() || !msg.has_member("msgType"))
+      return MSG_UNKNOWN;
+    const auto& type = msg["msgType"];
+    if (!type.is_string())
+      return MSG_UNKNOWN;
+    // every name fits the short string buffer, no allocation here
+    std::string name = type.template as<std::string>();
+    return parse_msg_type(name.data(), name.size());
+  }
+
+  msg_type parse_msg_type(const jsoncons::json& msg)
+  {
+    return parse_msg_type_of(msg);
+  }
+
+  msg_type parse_msg_type(const jsoncons::arena_json& msg)
+  {
+    return parse_msg_type_of(msg);
+  }
+
+  const char* msg_type_name(msg_type type)
+  {
+    return type > MSG_UNKNOWN && type < MSG_TYPE_COUNT ? MSG_TYPE_NAMES[type] : "unknown";
+  }
+
+  request request::from_json(const jsoncons::json& msg)
+  {
+    request r = request();
+    const auto& msg_type = msg["msgType"].as<std::string>();
+    const auto& data = msg["data"];
+    if (msg_type == "throttle") {
+      r.kind = THROTTLE;
+      // null for NaN, which the server drops like any value out of range
+      r.throttle = data.is_number() ? data.as<double>() : NAN;
+    } else if (msg_type == "switchLane") {
+      r.kind = SWITCH_LANE;
+      r.dir = data.as<std::string>() == "Left" ? -1 : 1;
+    } else if (msg_type == "turbo") {
+      r.kind = TURBO;
+    } else if (msg_type == "ping") {
+      r.kind = PING;
+    } else {
+      r.kind = OTHER;
+    }
+    return r;
+  }
+
+  outbox::outbox()
+  {
+    buf.reserve(1024);
+    reqs.reserve(8);
+  }
+
+  void outbox::clear()
+  {
+    buf.clear();
+    reqs.clear();
+  }
+
+  request& outbox::open(request::kind_t kind)
+  {
+    reqs.push_back(request());
+    request& r = reqs.back();
+    r.kind = kind;
+    r.begin = buf.size();
+    return r;
+  }
+
+  void outbox::close(request& r)
+  {
+    r.end = buf.size();
+    buf.push_back('\n');
+  }
+
+  void outbox::throttle(double value, int tick)
+  {
+    request& r = open(request::THROTTLE);
+    r.throttle = value;
+    append("{\"data\":");
+    append_double(value);
+    append(",\"gameTick\":");
+    append_int(tick);
+    append(",\"msgType\":\"throttle\"}");
+    close(r);
+  }
+
+  void outbox::lane_change(int dir)
+  {
+    request& r = open(request::SWITCH_LANE);
+    r.dir = dir;
+    append(dir == -1 ? "{\"data\":\"Left\"" : "{\"data\":\"Right\"");
+    append(",\"msgType\":\"switchLane\"}");
+    close(r);
+  }
+
+  void outbox::turbo(const std::string& msg)
+  {
+    // non-ascii is \u escaped by the serializer
+    for (unsigned char c: msg) {
+      if (c >= 0x80) {
+        add(make_turbo(msg));
+        return;
+      }
+    }
+    request& r = open(request::TURBO);
+    append("{\"data\":");
+    append_string(msg);
+    append(",\"msgType\":\"turbo\"}");
+    close(r);
+  }
+
+  void outbox::ping()
+  {
+    request& r = open(request::PING);
+    append("{\"data\":null,\"msgType\":\"ping\"}");
+    close(r);
+  }
+
+  void outbox::add(const jsoncons::json& msg)
+  {
+    jsoncons::output_format format;
+    format.escape_all_non_ascii(true);
+    request kind = request::from_json(msg);
+    request& r = open(kind.kind);
+    r.throttle = kind.throttle;
+    r.dir = kind.dir;
+    buf += msg.to_string(format);
+    close(r);
+  }
+
+  void outbox::append_string(const std::string& s)
+  {
+    static const char HEX[] = "0123456789abcdef";
+    buf.push_back('"');
+    for (char c: s) {
+      const char* esc = nullptr;
+      switch (c) {
+      case '"': esc = "\\\""; break;
+      case '\\': esc = "\\\\"; break;
+      case '\b': esc = "\\b"; break;
+      case '\f': esc = "\\f"; break;
+      case '\n': esc = "\\n"; break;
+      case '\r': esc = "\\r"; break;
+      case '\t': esc = "\\t"; break;
+      }
+      if (esc) {
+        buf.append(esc, 2);
+      } else if ((unsigned char)c < 0x20) {
+        char u[] = { '\\', 'u', '0', '0', HEX[c >> 4], HEX[c & 15] };
+        buf.append(u, sizeof u);
+      } else {
+        buf.push_back(c);
+      }
+    }
+    buf.push_back('"');
+  }
+
+  void outbox::append_int(long long x)
+  {
+    char tmp[24];
+    char* end = tmp + sizeof tmp;
+    char* p = end;
+    unsigned long long u = x < 0 ? 0ULL - x : x;
+    do {
+      *--p = '0' + u % 10;
+      u /= 10;
+    } while (u);
+    if (x < 0)
+      *--p = '-';
+    buf.append(p, end - p);
+  }
+
+  void outbox::append_double(double x)
+  {
+    if (std::isnan(x) || std::isinf(x)) {
+      append("null");
+      return;
+    }
+    // the digits the serializer would print, without its string
+    char tmp[jsoncons::double_buffer_size];
+    size_t n = jsoncons::format_double(tmp, x, 16);
+    if (n)
+      buf.append(tmp, n);
+    else
+      buf += jsoncons::double_to_string<char>(x, 16);
+  }
+}  // namespace hwo_protocol
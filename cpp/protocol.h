@@ -2,8 +2,10 @@
 #define HWO_PROTOCOL_H
 
 #include <string>
+#include <vector>
 #include <iostream>
 #include <jsoncons/json.hpp>
+#include <jsoncons/arena_storage.hpp>
 
 namespace hwo_protocol
 {
@@ -15,6 +17,82 @@ namespace hwo_protocol
   jsoncons::json make_throttle(double throttle, int tick);
   jsoncons::json make_lane_change(const std::string& dir);
   jsoncons::json make_turbo(const std::string& msg);
+
+  // every msgType the server sends, the race setup echoes included
+  enum msg_type {
+    MSG_UNKNOWN,
+    MSG_JOIN, MSG_CREATE_RACE, MSG_JOIN_RACE, MSG_YOUR_CAR,
+    MSG_GAME_INIT, MSG_GAME_START, MSG_CAR_POSITIONS,
+    MSG_CRASH, MSG_SPAWN, MSG_LAP_FINISHED, MSG_DNF, MSG_FINISH,
+    MSG_GAME_END, MSG_TOURNAMENT_END, MSG_ERROR,
+    MSG_TURBO_AVAILABLE, MSG_TURBO_START, MSG_TURBO_END,
+    MSG_TYPE_COUNT
+  };
+
+  // a switch on the length and the first letter and one compare
+  msg_type parse_msg_type(const char* s, size_t n);
+  msg_type parse_msg_type(const jsoncons::json& msg);
+  msg_type parse_msg_type(const jsoncons::arena_json& msg);
+  const char* msg_type_name(msg_type type);
+  // the turbo notifications have a gameTick but the carPositions of the
+  // same tick is the one to answer
+  inline bool needs_reply(msg_type type)
+  {
+    return type != MSG_TURBO_AVAILABLE && type != MSG_TURBO_START && type != MSG_TURBO_END;
+  }
+
+  // one line in an outbox, with what race_sim needs to know of it
+  struct request
+  {
+    enum kind_t { THROTTLE, SWITCH_LANE, TURBO, PING, OTHER };
+    kind_t kind;
+    double throttle; // THROTTLE
+    int dir; // SWITCH_LANE: -1 left, 1 right
+    size_t begin, end; // in outbox::text(), newline excluded
+
+    // msgType and data of one of make_throttle and friends
+    static request from_json(const jsoncons::json& msg);
+  };
+
+  // the replies to one message, written as json text straight into a buffer
+  // that is kept from tick to tick. the race time messages have fixed shapes
+  // so they need no json tree, no streams and after the first few ticks no
+  // allocation; the text is byte for byte what the make_ functions give
+  // (keys sorted).
+  class outbox
+  {
+  public:
+    typedef std::vector<request>::const_iterator const_iterator;
+
+    outbox();
+
+    void clear();
+    void throttle(double value, int tick);
+    void lane_change(int dir);
+    void turbo(const std::string& msg);
+    void ping();
+    // anything else, through the json serializer
+    void add(const jsoncons::json& msg);
+
+    bool empty() const { return reqs.empty(); }
+    size_t size() const { return reqs.size(); }
+    const request& operator[](size_t i) const { return reqs[i]; }
+    const_iterator begin() const { return reqs.begin(); }
+    const_iterator end() const { return reqs.end(); }
+    // all of the lines, each ending in a newline
+    const std::string& text() const { return buf; }
+
+  private:
+    request& open(request::kind_t kind);
+    void close(request& r);
+    void append(const char* s) { buf.append(s); }
+    void append_string(const std::string& s);
+    void append_int(long long x);
+    void append_double(double x);
+
+    std::string buf;
+    std::vector<request> reqs;
+  };
 }
 
 #endif
@@ -0,0 +1,341 @@
+#include "race_sim.h"
+#include <cmath>
+#include <algorithm>
+
+race_sim::race_sim(const jsoncons::json& track, const sim_config& config)
+  : config(config),
+    trackjson(track),
+    trk(track.as<Track>()),
+    cars(),
+    current_tick(0),
+    done(false),
+    positions_tick(nullptr)
+{
+}
+
+jsoncons::json race_sim::load_track(const std::string& filename)
+{
+  jsoncons::json j = jsoncons::json::parse_file(filename);
+  // a gameInit message copied from a rawlog works as well
+  if (j.has_member("msgType"))
+    return j["data"]["race"]["track"];
+  return j;
+}
+
+int race_sim::add_car(const std::string& name, const std::string& color)
+{
+  sim_car c {
+    name, color,
+    0.0, 0.0, 0.0,
+    0, 0.0, 0, 0,
+    0,
+    0.0, 0,
+    false, 0, false,
+    0, false,
+    0, 0, {}
+  };
+  cars.push_back(c);
+  return cars.size() - 1;
+}
+
+jsoncons::json race_sim::your_car(int car) const
+{
+  jsoncons::json r;
+  r["msgType"] = "yourCar";
+  r["data"] = car_id(cars[car]);
+  return r;
+}
+
+jsoncons::json race_sim::car_id(const sim_car& c) const
+{
+  jsoncons::json id;
+  id["name"] = c.name;
+  id["color"] = c.color;
+  return id;
+}
+
+void race_sim::event(const std::string& msg_type, const jsoncons::json& data, bool with_tick)
+{
+  jsoncons::json r;
+  r["msgType"] = msg_type;
+  r["data"] = data;
+  r["gameId"] = "sim";
+  if (with_tick)
+    r["gameTick"] = current_tick;
+  events.push_back(r);
+}
+
+const race_sim::msg_ptrs& race_sim::start()
+{
+  events.clear();
+  outbox.clear();
+  build_positions();
+
+  jsoncons::json carlist(jsoncons::json::an_array);
+  for (auto& c: cars) {
+    jsoncons::json car, dims;
+    car["id"] = car_id(c);
+    dims["length"] = 40.0;
+    dims["width"] = 20.0;
+    dims["guideFlagPosition"] = 10.0;
+    car["dimensions"] = dims;
+    carlist.add(car);
+  }
+  jsoncons::json session;
+  session["laps"] = config.laps;
+  session["maxLapTimeMs"] = 60000;
+  session["quickRace"] = true;
+
+  jsoncons::json race;
+  race["track"] = trackjson;
+  race["cars"] = carlist;
+  race["raceSession"] = session;
+  jsoncons::json init;
+  init["race"] = race;
+  event("gameInit", init, false);
+
+  // the first positions come before the start, without a tick
+  events.push_back(positions);
+  events.back().remove_member("gameTick");
+
+  event("gameStart", jsoncons::null_type(), true);
+
+  for (auto& m: events)
+    outbox.push_back(&m);
+  return outbox;
+}
+
+void race_sim::apply(int car, const hwo_protocol::request& reply)
+{
+  sim_car& c = cars[car];
+
+  if (reply.kind == hwo_protocol::request::THROTTLE) {
+    double t = reply.throttle;
+    // the server drops out of range values, this catches NaN too
+    if (t >= 0.0 && t <= 1.0)
+      c.throttle = t;
+  } else if (reply.kind == hwo_protocol::request::SWITCH_LANE) {
+    c.switch_dir = reply.dir;
+  } else if (reply.kind == hwo_protocol::request::TURBO) {
+    if (c.turbo_avail && c.crashed_left == 0) {
+      c.turbo_avail = false;
+      c.turbo_pending = true;
+    }
+  }
+}
+
+void race_sim::apply(int car, const jsoncons::json& reply)
+{
+  apply(car, hwo_protocol::request::from_json(reply));
+}
+
+const race_sim::msg_ptrs& race_sim::step()
+{
+  events.clear();
+  outbox.clear();
+  if (done)
+    return outbox;
+
+  current_tick++;
+
+  for (auto& c: cars) {
+    if (c.finished)
+      continue;
+    if (c.crashed_left > 0) {
+      if (--c.crashed_left == 0)
+        event("spawn", car_id(c), true);
+      continue;
+    }
+    if (c.turbo_pending) {
+      c.turbo_pending = false;
+      c.turbo_left = config.turbo_ticks;
+      event("turboStart", car_id(c), true);
+    }
+
+    move(c);
+    slide(c);
+
+    if (c.crashed_left == 0 && c.turbo_left > 0 && --c.turbo_left == 0)
+      event("turboEnd", car_id(c), true);
+  }
+
+  if (config.turbo_every > 0 && current_tick % config.turbo_every == 0) {
+    for (auto& c: cars)
+      if (c.crashed_left == 0 && !c.finished)
+        c.turbo_avail = true;
+    jsoncons::json turbo;
+    turbo["turboDurationMilliseconds"] = config.turbo_ticks * 1000.0 / 60;
+    turbo["turboDurationTicks"] = config.turbo_ticks;
+    turbo["turboFactor"] = config.turbo_factor;
+    event("turboAvailable", turbo, true);
+  }
+
+  bool all_done = true;
+  for (auto& c: cars)
+    all_done = all_done && c.finished;
+
+  if (all_done || current_tick >= config.max_ticks) {
+    done = true;
+    jsoncons::json results(jsoncons::json::an_array), best(jsoncons::json::an_array);
+    for (auto& c: cars) {
+      jsoncons::json res, lap, r;
+      res["laps"] = (int)c.lap_ticks.size();
+      res["ticks"] = c.lap_start;
+      res["millis"] = c.lap_start * 1000 / 60;
+      r["car"] = car_id(c);
+      r["result"] = res;
+      results.add(r);
+
+      int bestlap = c.lap_ticks.empty() ? 0 : *std::min_element(c.lap_ticks.begin(), c.lap_ticks.end());
+      lap["ticks"] = bestlap;
+      lap["millis"] = bestlap * 1000 / 60;
+      r["result"] = lap;
+      best.add(r);
+    }
+    jsoncons::json end;
+    end["results"] = results;
+    end["bestLaps"] = best;
+    event("gameEnd", end, false);
+    event("tournamentEnd", jsoncons::null_type(), false);
+  } else {
+    update_positions();
+  }
+
+  for (auto& m: events)
+    outbox.push_back(&m);
+  if (!done)
+    outbox.push_back(&positions);
+  return outbox;
+}
+
+double race_sim::piece_length(const sim_car& c) const
+{
+  const Piece& p = trk.track[c.piece];
+  if (c.startLane == c.endLane)
+    return p.travel(trk.lanedist[c.startLane]);
+
+  double from = trk.lanedist[c.startLane], to = trk.lanedist[c.endLane];
+  if (p.length) {
+    // the diagonal across the lanes
+    return std::sqrt(p.length * p.length + (to - from) * (to - from));
+  }
+  // somewhere between the two lanes
+  return (p.travel(from) + p.travel(to)) / 2;
+}
+
+void race_sim::move(sim_car& c)
+{
+  double thr = c.throttle * (c.turbo_left > 0 ? config.turbo_factor : 1.0);
+  c.speed = config.drag * c.speed + config.power * thr;
+  c.inPieceDistance += c.speed;
+
+  double len;
+  while (c.inPieceDistance >= (len = piece_length(c))) {
+    c.inPieceDistance -= len;
+    c.startLane = c.endLane;
+    c.piece++;
+    if (c.piece == (int)trk.track.size()) {
+      c.piece = 0;
+      c.lap++;
+      c.lap_ticks.push_back(current_tick - c.lap_start);
+      c.lap_start = current_tick;
+
+      jsoncons::json laptime, lap;
+      laptime["lap"] = c.lap - 1;
+      laptime["ticks"] = c.lap_ticks.back();
+      laptime["millis"] = c.lap_ticks.back() * 1000 / 60;
+      lap["car"] = car_id(c);
+      lap["lapTime"] = laptime;
+      event("lapFinished", lap, true);
+
+      if (c.lap == config.laps) {
+        c.finished = true;
+        event("finish", car_id(c), true);
+        return;
+      }
+    }
+    if (trk.track[c.piece].switch_ && c.switch_dir) {
+      c.endLane = std::min(std::max(c.startLane + c.switch_dir, 0), trk.nlanes - 1);
+      c.switch_dir = 0;
+    }
+  }
+}
+
+void race_sim::slide(sim_car& c)
+{
+  // a spring back to zero angle, damped, pushed outwards in bends when the
+  // centripetal force is over what the tires can hold
+  const Piece& p = trk.track[c.piece];
+  double force = 0.0;
+  if (p.length == 0.0) {
+    double dir = p.angle > 0 ? 1.0 : -1.0;
+    double r = p.radius - dir * trk.lanedist[c.startLane];
+    force = dir * std::max(0.0, 0.53033 * c.speed * c.speed / std::sqrt(r) - 0.3 * c.speed);
+  }
+  c.angspeed += force - 0.1 * c.angspeed - 0.00125 * c.speed * c.angle;
+  c.angle += c.angspeed;
+
+  if (std::abs(c.angle) > config.crash_angle) {
+    c.crashes++;
+    c.crashed_left = config.respawn_ticks;
+    c.speed = c.angle = c.angspeed = 0.0;
+    c.turbo_avail = c.turbo_pending = false;
+    c.turbo_left = 0;
+    event("crash", car_id(c), true);
+  }
+}
+
+void race_sim::build_positions()
+{
+  jsoncons::json data(jsoncons::json::an_array);
+  for (auto& c: cars) {
+    jsoncons::json p, pos, lane;
+    lane["startLaneIndex"] = c.startLane;
+    lane["endLaneIndex"] = c.endLane;
+    pos["pieceIndex"] = c.piece;
+    pos["inPieceDistance"] = c.inPieceDistance;
+    pos["lane"] = lane;
+    pos["lap"] = c.lap;
+    p["id"] = car_id(c);
+    p["angle"] = c.angle;
+    p["piecePosition"] = pos;
+    data.add(p);
+  }
+  positions = jsoncons::json();
+  positions["msgType"] = "carPositions";
+  positions["data"] = data;
+  positions["gameId"] = "sim";
+  positions["gameTick"] = current_tick;
+
+  // nothing is added to the message after this, so the nodes stay put
+  positions_tick = &positions.at("gameTick");
+  slots.clear();
+  jsoncons::json& d = positions.at("data");
+  for (size_t i = 0; i < cars.size(); i++) {
+    jsoncons::json& p = d.at(i);
+    jsoncons::json& pos = p.at("piecePosition");
+    slots.push_back(position_slots {
+      &p.at("angle"),
+      &pos.at("pieceIndex"),
+      &pos.at("inPieceDistance"),
+      &pos.at("lane").at("startLaneIndex"),
+      &pos.at("lane").at("endLaneIndex"),
+      &pos.at("lap")
+    });
+  }
+}
+
+void race_sim::update_positions()
+{
+  *positions_tick = current_tick;
+  for (size_t i = 0; i < cars.size(); i++) {
+    const sim_car& c = cars[i];
+    position_slots& s = slots[i];
+    *s.angle = c.angle;
+    *s.pieceIndex = c.piece;
+    *s.inPieceDistance = c.inPieceDistance;
+    *s.startLaneIndex = c.startLane;
+    *s.endLaneIndex = c.endLane;
+    *s.lap = c.lap;
+  }
+}
@@ -0,0 +1,108 @@
+#ifndef RACE_SIM_H
+#define RACE_SIM_H
+
+#include "game_objs.h"
+#include "protocol.h"
+#include <string>
+#include <vector>
+#include <jsoncons/json.hpp>
+
+// an offline stand-in for the race server. speed follows the same
+// v_n+1 = drag * v_n + power * throttle model that Player estimates, and the
+// slip angle is a damped spring driven by the centripetal force in bends.
+// crashes, turbos and lane switches work like on the real server.
+struct sim_config {
+  int laps;
+  double power, drag;
+  int turbo_every; // ticks between turboAvailable messages, 0 for none
+  int turbo_ticks;
+  double turbo_factor;
+  double crash_angle;
+  int respawn_ticks;
+  int max_ticks; // give up on bots that stop moving
+
+  sim_config()
+    : laps(3), power(0.2), drag(0.98),
+      turbo_every(600), turbo_ticks(30), turbo_factor(3.0),
+      crash_angle(60.0), respawn_ticks(400), max_ticks(100000)
+  {}
+};
+
+struct sim_car {
+  std::string name, color;
+  double speed, angle, angspeed;
+  int piece;
+  double inPieceDistance;
+  int startLane, endLane;
+  int lap;
+  double throttle;
+  int switch_dir; // requested lane change for the next switch
+  bool turbo_avail;
+  int turbo_left;
+  bool turbo_pending;
+  int crashed_left; // ticks until respawn, 0 when on track
+  bool finished;
+
+  int crashes;
+  int lap_start;
+  std::vector<int> lap_ticks;
+};
+
+class race_sim
+{
+public:
+  typedef std::vector<const jsoncons::json*> msg_ptrs;
+
+  race_sim(const jsoncons::json& track, const sim_config& config);
+
+  // the track object from a track file or the data of a gameInit dump
+  static jsoncons::json load_track(const std::string& filename);
+
+  int add_car(const std::string& name, const std::string& color);
+  jsoncons::json your_car(int car) const;
+
+  // gameInit, the initial positions and gameStart; valid until the next call
+  const msg_ptrs& start();
+  // the bot's answer to the latest tick: throttle, switchLane or turbo
+  void apply(int car, const hwo_protocol::request& reply);
+  void apply(int car, const jsoncons::json& reply);
+  // advance one tick. the events of the tick and then the positions, or
+  // gameEnd and tournamentEnd after everyone has finished
+  const msg_ptrs& step();
+
+  bool finished() const { return done; }
+  int tick() const { return current_tick; }
+  const sim_car& car(int i) const { return cars[i]; }
+  int ncars() const { return cars.size(); }
+  const Track& track() const { return trk; }
+
+private:
+  void move(sim_car& c);
+  void slide(sim_car& c);
+  double piece_length(const sim_car& c) const;
+  void event(const std::string& msg_type, const jsoncons::json& data, bool with_tick);
+  jsoncons::json car_id(const sim_car& c) const;
+  void build_positions();
+  void update_positions();
+
+  sim_config config;
+  jsoncons::json trackjson;
+  Track trk;
+  std::vector<sim_car> cars;
+  int current_tick;
+  bool done;
+
+  std::vector<jsoncons::json> events;
+  msg_ptrs outbox;
+
+  // carPositions is built once and then only its numbers are rewritten, so
+  // these point into it. car order matches cars
+  jsoncons::json positions;
+  jsoncons::json* positions_tick;
+  struct position_slots {
+    jsoncons::json *angle, *pieceIndex, *inPieceDistance, *startLaneIndex, *endLaneIndex, *lap;
+  };
+  std::vector<position_slots> slots;
+};
+
+#endif
@@ -0,0 +1,106 @@
+#include "rawlog.h"
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+// the length of the marker at s ("<< ", "<<< " or ">> "), 0 if there is none
+size_t marker(const char* s, const char* end, bool& sent)
+{
+  const char* p = s;
+  char c = p < end ? *p : 0;
+  if (c != '<' && c != '>')
+    return 0;
+  while (p < end && *p == c)
+    p++;
+  if (p - s < 2 || (c == '>' && p - s != 2) || p == end || *p != ' ')
+    return 0;
+  sent = c == '>';
+  return p + 1 - s;
+}
+
+// where the message starting at s ends: the newline, or a marker right
+// after a closing brace in a glued line
+const char* message_end(const char* s, const char* end)
+{
+  const char* nl = (const char*)std::memchr(s, '\n', end - s);
+  const char* stop = nl ? nl : end;
+  for (const char* p = s; (p = (const char*)std::memchr(p, '}', stop - p)) != nullptr; ) {
+    p++;
+    bool sent;
+    if (p < stop && (*p == '<' || *p == '>') && marker(p, stop, sent) > 0)
+      return p;
+  }
+  return stop;
+}
+
+}
+
+rawlog_file::rawlog_file(const std::string& filename)
+  : base(nullptr), length(0), pos(nullptr), line(1), nskipped(0)
+{
+  int fd = open(filename.c_str(), O_RDONLY);
+  if (fd < 0)
+    throw std::runtime_error("cannot open " + filename + ": " + std::strerror(errno));
+  struct stat st;
+  if (fstat(fd, &st) != 0) {
+    close(fd);
+    throw std::runtime_error("cannot stat " + filename + ": " + std::strerror(errno));
+  }
+  length = st.st_size;
+  if (length > 0) {
+    void* p = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (p == MAP_FAILED) {
+      close(fd);
+      throw std::runtime_error("cannot map " + filename + ": " + std::strerror(errno));
+    }
+    // read once front to back
+    madvise(p, length, MADV_SEQUENTIAL);
+    base = (const char*)p;
+  }
+  close(fd);
+  pos = base;
+}
+
+rawlog_file::~rawlog_file()
+{
+  if (base)
+    munmap((void*)base, length);
+}
+
+void rawlog_file::rewind()
+{
+  pos = base;
+  line = 1;
+  nskipped = 0;
+}
+
+bool rawlog_file::next(entry& e)
+{
+  const char* end = base + length;
+  while (pos < end) {
+    if (*pos == '\n') {
+      pos++;
+      line++;
+      continue;
+    }
+    size_t m = marker(pos, end, e.sent);
+    if (m == 0) {
+      const char* nl = (const char*)std::memchr(pos, '\n', end - pos);
+      pos = nl ? nl : end;
+      nskipped++;
+      continue;
+    }
+    e.data = pos + m;
+    pos = message_end(e.data, end);
+    e.size = pos - e.data;
+    e.line = line;
+    return true;
+  }
+  return false;
+}
@@ -0,0 +1,43 @@
+#ifndef RAWLOG_H
+#define RAWLOG_H
+
+#include <cstddef>
+#include <string>
+
+// a rawlog of hwo_connection mapped in full and read in place: "<< " before
+// each line the server sent, ">> " before each line the bot sent. older
+// logs have "<<< " too, and a sent line and the next received one may be
+// glued together without the newline in between; both read the same.
+class rawlog_file
+{
+public:
+  struct entry {
+    bool sent; // by the bot
+    const char* data; // the json text, no marker and no newline
+    size_t size;
+    size_t line; // in the file, from 1
+  };
+
+  explicit rawlog_file(const std::string& filename);
+  ~rawlog_file();
+
+  // the next message; false at the end. lines without a marker are skipped
+  bool next(entry& e);
+  // back to the first message
+  void rewind();
+
+  size_t bytes() const { return length; }
+  size_t skipped() const { return nskipped; }
+
+private:
+  rawlog_file(const rawlog_file&);
+  rawlog_file& operator=(const rawlog_file&);
+
+  const char* base;
+  size_t length;
+  const char* pos;
+  size_t line;
+  size_t nskipped;
+};
+
+#endif
@@ -0,0 +1,217 @@
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cmath>
+#include "jsoncons/json.hpp"
+#include "rawlog.h"
+#include "inbox.h"
+#include "game_logic.h"
+#include "latency.h"
+#include "logger.h"
+
+// what a fresh game_logic makes of one rawlog next to what the bot sent
+// when it was recorded
+struct replay_result
+{
+  size_t received = 0;
+  size_t replies = 0; // compared to the recording
+  size_t differing = 0;
+  std::vector<std::string> diffs; // the first few
+};
+
+namespace {
+
+const size_t MAX_DIFFS = 5;
+
+std::string clip(const char* s, size_t n)
+{
+  const size_t max = 160;
+  return n <= max ? std::string(s, n) : std::string(s, max) + "...";
+}
+
+// the replies agree byte for byte, or both are throttles whose values are
+// within the relative tolerance and whose other fields are equal
+bool same_reply(const char* recorded, size_t m, const char* replayed, size_t n, double tolerance)
+{
+  if (n == m && std::char_traits<char>::compare(recorded, replayed, n) == 0)
+    return true;
+  try
+  {
+    jsoncons::json a = jsoncons::json::parse_string(std::string(recorded, m));
+    jsoncons::json b = jsoncons::json::parse_string(std::string(replayed, n));
+    if (!a.is_object() || !b.is_object() || !a.has_member("msgType") || !b.has_member("msgType")
+      || a["msgType"].as<std::string>() != "throttle" || b["msgType"].as<std::string>() != "throttle"
+      || !a.has_member("data") || !b.has_member("data")
+      || !a["data"].is_number() || !b["data"].is_number())
+      return false;
+    double x = a["data"].as<double>(), y = b["data"].as<double>();
+    if (std::abs(x - y) > tolerance * std::max(std::abs(x), std::abs(y)))
+      return false;
+    a["data"] = 0.0;
+    b["data"] = 0.0;
+    return a == b;
+  }
+  catch (const std::exception&)
+  {
+    return false;
+  }
+}
+
+class replayer
+{
+public:
+  replayer(replay_result& result, tick_latency& lat, double tolerance)
+    : result(result), lat(lat), tolerance(tolerance), pending(nullptr), next(0), line(0) {}
+
+  void received(const rawlog_file::entry& e)
+  {
+    finish();
+    auto t0 = tick_latency::clock::now();
+    in.decode(e.data, e.size);
+    auto t1 = tick_latency::clock::now();
+    pending = &in.react(game);
+    auto t2 = tick_latency::clock::now();
+    in.release();
+    lat.parse.record(std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count());
+    lat.react.record(std::chrono::duration_cast<std::chrono::nanoseconds>(t2 - t1).count());
+    next = 0;
+    line = e.line;
+    result.received++;
+  }
+
+  void sent(const rawlog_file::entry& e)
+  {
+    // the join before the first message is not a reply
+    if (result.received == 0)
+      return;
+    result.replies++;
+    if (!pending || next >= pending->size()) {
+      diff(e.line, "recorded " + clip(e.data, e.size) + ", replayed nothing");
+      return;
+    }
+    const hwo_protocol::request& r = (*pending)[next++];
+    const char* s = pending->text().data() + r.begin;
+    size_t n = r.end - r.begin;
+    if (!same_reply(e.data, e.size, s, n, tolerance))
+      diff(e.line, "recorded " + clip(e.data, e.size) + ", replayed " + clip(s, n));
+  }
+
+  // replies the recording does not have
+  void finish()
+  {
+    for (; pending && next < pending->size(); next++) {
+      const hwo_protocol::request& r = (*pending)[next];
+      diff(line, "recorded nothing, replayed " + clip(pending->text().data() + r.begin, r.end - r.begin));
+    }
+    pending = nullptr;
+  }
+
+private:
+  void diff(size_t at, const std::string& what)
+  {
+    result.differing++;
+    if (result.diffs.size() < MAX_DIFFS)
+      result.diffs.push_back("line " + std::to_string(at) + ": " + what);
+  }
+
+  replay_result& result;
+  tick_latency& lat;
+  double tolerance; // relative, for throttle values
+  game_logic game;
+  inbox in;
+  const game_logic::msg_vector* pending;
+  size_t next; // of pending, the next to compare
+  size_t line; // of the message pending answers
+};
+
+}
+
+replay_result replay(const std::string& filename, tick_latency& lat, double tolerance)
+{
+  replay_result result;
+  rawlog_file log(filename);
+  replayer r(result, lat, tolerance);
+  rawlog_file::entry e;
+  while (log.next(e)) {
+    if (e.sent)
+      r.sent(e);
+    else
+      r.received(e);
+  }
+  r.finish();
+  return result;
+}
+
+int main(int argc, const char* argv[])
+{
+  std::vector<std::string> files;
+  bool verbose = false;
+  double tolerance = 1e-9;
+  try
+  {
+    for (int i = 1; i < argc; i++) {
+      std::string arg(argv[i]);
+      if (arg == "verbose")
+        verbose = true;
+      else if (arg.compare(0, 10, "tolerance=") == 0)
+        tolerance = std::stod(arg.substr(10));
+      else
+        files.push_back(arg);
+    }
+  }
+  catch (const std::exception& e)
+  {
+    std::cerr << e.what() << std::endl;
+    files.clear();
+  }
+  if (files.empty())
+  {
+    std::cerr << "Usage: ./replay [verbose] [tolerance=1e-9] rawlog..." << std::endl;
+    std::cerr << "runs each rawlog through a fresh game_logic and compares its replies to the recorded ones" << std::endl;
+    std::cerr << "throttle values may differ by the relative tolerance, everything else must match exactly" << std::endl;
+    std::cerr << "the reference recordings are rawlog.txt and rawlogkeimola.txt, kept out of git" << std::endl;
+    return 2;
+  }
+
+  // the same as simrace: the bot's logging is not what is measured
+  std::ostream out(std::cout.rdbuf());
+  if (!verbose) {
+    std::cout.rdbuf(nullptr);
+    std::cerr.rdbuf(nullptr);
+  }
+
+  tick_latency lat;
+  size_t messages = 0, differing = 0;
+  auto t0 = std::chrono::steady_clock::now();
+  try
+  {
+    for (const std::string& file: files) {
+      replay_result r = replay(file, lat, tolerance);
+      logging::flush();
+      out << file << ": " << r.received << " messages, "
+        << r.replies << " replies, " << r.differing << " differing" << std::endl;
+      for (const std::string& d: r.diffs)
+        out << "  " << d << std::endl;
+      messages += r.received;
+      differing += r.differing;
+    }
+  }
+  catch (const std::exception& e)
+  {
+    out << e.what() << std::endl;
+    return 2;
+  }
+  double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+  out << messages << " messages in " << secs << " s: " << messages / secs << " msgs/s" << std::endl;
+  out << std::fixed << std::setprecision(1);
+  for (auto h: { std::make_pair("parse", &lat.parse), std::make_pair("react", &lat.react) }) {
+    out << h.first << " us: p50 " << h.second->percentile(0.5) / 1e3
+      << ", p99 " << h.second->percentile(0.99) / 1e3
+      << ", p99.9 " << h.second->percentile(0.999) / 1e3
+      << ", max " << h.second->max() / 1e3 << std::endl;
+  }
+  return differing == 0 ? 0 : 1;
+}
@@ -0,0 +1,96 @@
+#include <iostream>
+#include <string>
+#include <chrono>
+#include <jsoncons/json.hpp>
+#include "race_sim.h"
+#include "game_logic.h"
+#include "logger.h"
+
+// one race against the simulator, the bot answering each message in place
+// like run() in main.cpp does over the socket
+sim_car run_race(const jsoncons::json& track, const sim_config& config)
+{
+  race_sim sim(track, config);
+  game_logic game;
+
+  int me = sim.add_car("plusbot", "red");
+  game.react(sim.your_car(me));
+
+  const race_sim::msg_ptrs* msgs = &sim.start();
+  for (;;) {
+    for (const jsoncons::json* m: *msgs)
+      for (const hwo_protocol::request& reply: game.react(*m))
+        sim.apply(me, reply);
+    if (sim.finished())
+      break;
+    msgs = &sim.step();
+  }
+  return sim.car(me);
+}
+
+int main(int argc, const char* argv[])
+{
+  if (argc < 2 || argc > 5)
+  {
+    std::cerr << "Usage: ./simrace trackfile [laps] [races] [verbose]" << std::endl;
+    std::cerr << "trackfile is a track object like keimola.json or a gameInit message" << std::endl;
+    return 1;
+  }
+
+  sim_config config;
+  const std::string trackfile(argv[1]);
+  if (argc >= 3)
+    config.laps = std::stoi(argv[2]);
+  int races = argc >= 4 ? std::stoi(argv[3]) : 1;
+  bool verbose = argc >= 5;
+
+  // the bot logs every tick to cout and cerr; keep the summary on the
+  // original stream and drop the rest unless asked
+  std::ostream out(std::cout.rdbuf());
+  if (!verbose) {
+    std::cout.rdbuf(nullptr);
+    std::cerr.rdbuf(nullptr);
+  }
+
+  try
+  {
+    jsoncons::json track = race_sim::load_track(trackfile);
+
+    long long totticks = 0, totlaps = 0;
+    auto t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < races; i++) {
+      sim_car car = run_race(track, config);
+      int ticks = 0, best = 0;
+      for (int t: car.lap_ticks) {
+        ticks += t;
+        if (best == 0 || t < best)
+          best = t;
+      }
+      totticks += ticks;
+      totlaps += car.lap_ticks.size();
+      if (i == 0 || verbose) {
+        logging::flush();
+        out << "race " << i << ": laps " << car.lap_ticks.size()
+          << ", ticks " << ticks
+          << ", best lap " << best
+          << ", crashes " << car.crashes
+          << ", lap ticks";
+        for (int t: car.lap_ticks)
+          out << " " << t;
+        out << std::endl;
+      }
+    }
+    double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+    out << races << " races, " << totlaps << " laps, " << totticks << " ticks in " << secs << " s: "
+      << totlaps / secs << " laps/s, "
+      << totticks / secs << " ticks/s" << std::endl;
+  }
+  catch (const std::exception& e)
+  {
+    out << e.what() << std::endl;
+    return 2;
+  }
+
+  return 0;
+}
@@ -0,0 +1,257 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <chrono>
+#include <random>
+#include <stdexcept>
+#include <jsoncons/json.hpp>
+#include "race_sim.h"
+#include "game_logic.h"
+#include "logger.h"
+#include "work_pool.h"
+
+// the values one player_config field takes: a list, or lo:hi[:step], which
+// is every step from lo to hi in a grid and uniform over [lo, hi] at random
+struct sweep_axis {
+  std::string name;
+  std::vector<double> values;
+  bool range;
+  double lo, hi, step;
+};
+
+struct race_result {
+  int laps, ticks, best, crashes;
+  bool finished;
+  std::vector<int> lap_ticks;
+};
+
+namespace {
+
+sweep_axis parse_axis(const std::string& name, const std::string& spec)
+{
+  sweep_axis a;
+  a.name = name;
+  a.range = spec.find(':') != std::string::npos;
+  a.lo = a.hi = 0.0;
+  a.step = 1.0;
+  std::istringstream in(spec);
+  std::string item;
+  if (a.range) {
+    std::vector<double> parts;
+    while (std::getline(in, item, ':'))
+      parts.push_back(std::stod(item));
+    if (parts.size() < 2 || parts.size() > 3)
+      throw std::runtime_error("bad range " + spec + ", want lo:hi or lo:hi:step");
+    a.lo = parts[0];
+    a.hi = parts[1];
+    if (parts.size() == 3)
+      a.step = parts[2];
+    if (a.step <= 0.0 || a.hi < a.lo)
+      throw std::runtime_error("empty range " + spec);
+    // steps counted, not summed, so 0.55:0.7:0.01 ends at 0.7
+    int n = (int)std::floor((a.hi - a.lo) / a.step + 1e-9);
+    for (int i = 0; i <= n; i++)
+      a.values.push_back(a.lo + i * a.step);
+  } else {
+    while (std::getline(in, item, ','))
+      a.values.push_back(std::stod(item));
+  }
+  return a;
+}
+
+// every combination of the axes, the first axis changing slowest
+std::vector<player_config> grid(const std::vector<sweep_axis>& axes)
+{
+  std::vector<player_config> configs(1);
+  for (const sweep_axis& a: axes) {
+    std::vector<player_config> next;
+    for (const player_config& c: configs) {
+      for (double v: a.values) {
+        next.push_back(c);
+        next.back().set(a.name, v);
+      }
+    }
+    configs.swap(next);
+  }
+  return configs;
+}
+
+std::vector<player_config> random_search(const std::vector<sweep_axis>& axes, int n, unsigned seed)
+{
+  std::mt19937 rng(seed);
+  std::vector<player_config> configs(n);
+  for (player_config& c: configs) {
+    for (const sweep_axis& a: axes) {
+      if (a.range)
+        c.set(a.name, std::uniform_real_distribution<double>(a.lo, a.hi)(rng));
+      else
+        c.set(a.name, a.values[std::uniform_int_distribution<size_t>(0, a.values.size() - 1)(rng)]);
+    }
+  }
+  return configs;
+}
+
+// like run_race in simrace.cpp, for a given config
+race_result run_race(const jsoncons::json& track, const sim_config& sim, const player_config& config)
+{
+  race_sim race(track, sim);
+  game_logic game(config);
+
+  int me = race.add_car("plusbot", "red");
+  game.react(race.your_car(me));
+
+  const race_sim::msg_ptrs* msgs = &race.start();
+  for (;;) {
+    for (const jsoncons::json* m: *msgs)
+      for (const hwo_protocol::request& reply: game.react(*m))
+        race.apply(me, reply);
+    if (race.finished())
+      break;
+    msgs = &race.step();
+  }
+
+  const sim_car& car = race.car(me);
+  race_result r { (int)car.lap_ticks.size(), 0, 0, car.crashes, car.finished, car.lap_ticks };
+  for (int t: car.lap_ticks) {
+    r.ticks += t;
+    if (r.best == 0 || t < r.best)
+      r.best = t;
+  }
+  return r;
+}
+
+}
+
+int main(int argc, const char* argv[])
+{
+  std::vector<std::string> trackfiles;
+  std::vector<sweep_axis> axes;
+  int random = 0;
+  unsigned seed = 1, threads = 0;
+  std::string outfile = "sweep.tsv";
+  sim_config sim;
+
+  try
+  {
+    for (int i = 1; i < argc; i++) {
+      std::string arg(argv[i]);
+      size_t eq = arg.find('=');
+      if (eq == std::string::npos) {
+        trackfiles.push_back(arg);
+        continue;
+      }
+      std::string name = arg.substr(0, eq), value = arg.substr(eq + 1);
+      if (name == "random")
+        random = std::stoi(value);
+      else if (name == "seed")
+        seed = std::stoul(value);
+      else if (name == "threads")
+        threads = std::stoul(value);
+      else if (name == "laps")
+        sim.laps = std::stoi(value);
+      else if (name == "out")
+        outfile = value;
+      else if (std::find(player_config::names().begin(), player_config::names().end(), name) != player_config::names().end())
+        axes.push_back(parse_axis(name, value));
+      else
+        throw std::runtime_error("unknown setting " + name);
+    }
+  }
+  catch (const std::exception& e)
+  {
+    std::cerr << e.what() << std::endl;
+    trackfiles.clear();
+  }
+  if (trackfiles.empty())
+  {
+    std::cerr << "Usage: ./sweep [field=values]... [random=n] [seed=n] [laps=n] [threads=n] [out=sweep.tsv] trackfile..." << std::endl;
+    std::cerr << "races every combination of the values, or n configs drawn from them, on each track" << std::endl;
+    std::cerr << "values are a list (2,3,4) or a range lo:hi[:step]; the fields are";
+    for (const std::string& n: player_config::names())
+      std::cerr << " " << n;
+    std::cerr << std::endl;
+    return 1;
+  }
+
+  // game_logic logs from every thread otherwise
+  logging::disable();
+
+  try
+  {
+    std::vector<jsoncons::json> tracks;
+    for (const std::string& f: trackfiles)
+      tracks.push_back(race_sim::load_track(f));
+
+    // the defaults first, to compare against
+    std::vector<player_config> configs(1);
+    if (!axes.empty()) {
+      std::vector<player_config> swept = random > 0 ? random_search(axes, random, seed) : grid(axes);
+      configs.insert(configs.end(), swept.begin(), swept.end());
+    }
+
+    size_t ntracks = tracks.size();
+    std::vector<race_result> results(configs.size() * ntracks);
+    auto t0 = std::chrono::steady_clock::now();
+    parallel_for(results.size(), threads, [&](size_t job) {
+      results[job] = run_race(tracks[job % ntracks], sim, configs[job / ntracks]);
+    });
+    double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+    std::ofstream out(outfile);
+    if (!out)
+      throw std::runtime_error("cannot write " + outfile);
+    out << "config";
+    for (const std::string& n: player_config::names())
+      out << "\t" << n;
+    out << "\ttrack\tlaps\tticks\tbest\tcrashes\tfinished\tlap_ticks\n";
+    for (size_t job = 0; job < results.size(); job++) {
+      const player_config& c = configs[job / ntracks];
+      const race_result& r = results[job];
+      out << job / ntracks;
+      for (const std::string& n: player_config::names())
+        out << "\t" << c.get(n);
+      out << "\t" << trackfiles[job % ntracks] << "\t" << r.laps << "\t" << r.ticks
+        << "\t" << r.best << "\t" << r.crashes << "\t" << r.finished << "\t";
+      for (size_t i = 0; i < r.lap_ticks.size(); i++)
+        out << (i ? "," : "") << r.lap_ticks[i];
+      out << "\n";
+    }
+
+    // ranked by the ticks over all the tracks; a race that did not finish
+    // counts as the simulator's limit
+    std::vector<long long> total(configs.size(), 0);
+    std::vector<int> crashes(configs.size(), 0);
+    for (size_t job = 0; job < results.size(); job++) {
+      const race_result& r = results[job];
+      total[job / ntracks] += r.finished ? r.ticks : sim.max_ticks;
+      crashes[job / ntracks] += r.crashes;
+    }
+    std::vector<size_t> order(configs.size());
+    for (size_t i = 0; i < order.size(); i++)
+      order[i] = i;
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) { return total[a] < total[b]; });
+
+    std::cout << results.size() << " races in " << secs << " s on " << (threads ? threads : core_count())
+      << " threads: " << results.size() / secs << " races/s, table in " << outfile << std::endl;
+    for (size_t k = 0; k < order.size(); k++) {
+      size_t i = order[k];
+      if (k >= 10 && i != 0)
+        continue;
+      std::cout << "config " << i << ":";
+      for (const std::string& n: player_config::names())
+        std::cout << " " << n << "=" << configs[i].get(n);
+      std::cout << ", ticks " << total[i] << ", crashes " << crashes[i]
+        << (i == 0 ? " (defaults)" : "") << std::endl;
+    }
+  }
+  catch (const std::exception& e)
+  {
+    std::cerr << e.what() << std::endl;
+    return 2;
+  }
+  return 0;
+}
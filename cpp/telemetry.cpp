@@ -0,0 +1,180 @@
+#include "telemetry.h"
+#include "logger.h"
+#include <cmath>
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace telemetry;
+
+namespace {
+
+struct field {
+  const char* name;
+  col_type type;
+  size_t offset; // in telemetry_row
+};
+
+#define FIELD(name, type) { #name, type, offsetof(telemetry_row, name) }
+const field FIELDS[] = {
+  FIELD(tick, INT32),
+  FIELD(car, INT32),
+  FIELD(piece, INT32),
+  FIELD(startLane, INT32),
+  FIELD(endLane, INT32),
+  FIELD(lap, INT32),
+  FIELD(inPieceDistance, DOUBLE),
+  FIELD(angle, DOUBLE),
+  FIELD(nticks, INT32),
+  FIELD(tottravel, DOUBLE),
+  FIELD(speed, DOUBLE),
+  FIELD(angspeed, DOUBLE),
+  FIELD(throttle, DOUBLE),
+  FIELD(turbofactor, DOUBLE),
+};
+#undef FIELD
+const int NFIELDS = sizeof FIELDS / sizeof FIELDS[0];
+static_assert(NFIELDS <= MAX_COLUMNS, "too many telemetry columns");
+
+size_t type_size(uint32_t type) {
+  return type == DOUBLE ? sizeof(double) : sizeof(int32_t);
+}
+
+}
+
+telemetry_recorder::telemetry_recorder(const std::string& filename, uint64_t capacity)
+  : base(nullptr), length(0), hdr(nullptr), cols(), ndropped(0)
+{
+  // columns start on cache lines
+  uint64_t offsets[NFIELDS];
+  uint64_t at = (sizeof(header) + 63) & ~uint64_t(63);
+  for (int i = 0; i < NFIELDS; i++) {
+    offsets[i] = at;
+    at = (at + capacity * type_size(FIELDS[i].type) + 63) & ~uint64_t(63);
+  }
+  length = at;
+
+  int fd = open(filename.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0 || ftruncate(fd, length) != 0) {
+    LOG_WARN(logging::OUT) << "telemetry: cannot create " << filename << ": " << std::strerror(errno);
+    if (fd >= 0)
+      close(fd);
+    return;
+  }
+  void* p = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (p == MAP_FAILED) {
+    LOG_WARN(logging::OUT) << "telemetry: cannot map " << filename << ": " << std::strerror(errno);
+    return;
+  }
+  base = (char*)p;
+
+  hdr = (header*)base;
+  std::memcpy(hdr->magic, MAGIC, sizeof MAGIC);
+  hdr->version = VERSION;
+  hdr->ncolumns = NFIELDS;
+  hdr->capacity = capacity;
+  hdr->rows = 0;
+  for (int i = 0; i < NFIELDS; i++) {
+    column& c = hdr->columns[i];
+    std::strncpy(c.name, FIELDS[i].name, sizeof c.name - 1);
+    c.type = FIELDS[i].type;
+    c.size = type_size(c.type);
+    c.offset = offsets[i];
+    cols[i] = base + offsets[i];
+  }
+}
+
+telemetry_recorder::~telemetry_recorder()
+{
+  if (base)
+    munmap(base, length);
+  if (ndropped) {
+    LOG_WARN(logging::OUT) << "telemetry: " << ndropped << " rows did not fit";
+  }
+}
+
+void telemetry_recorder::append(const telemetry_row& row)
+{
+  if (!base)
+    return;
+  uint64_t r = hdr->rows;
+  if (r == hdr->capacity) {
+    ndropped++;
+    return;
+  }
+  const char* src = (const char*)&row;
+  for (int i = 0; i < NFIELDS; i++) {
+    if (FIELDS[i].type == DOUBLE)
+      std::memcpy(cols[i] + r * sizeof(double), src + FIELDS[i].offset, sizeof(double));
+    else
+      std::memcpy(cols[i] + r * sizeof(int32_t), src + FIELDS[i].offset, sizeof(int32_t));
+  }
+  hdr->rows = r + 1;
+}
+
+telemetry_file::telemetry_file(const std::string& filename)
+  : base(nullptr), length(0), hdr(nullptr), cols()
+{
+  int fd = open(filename.c_str(), O_RDONLY);
+  if (fd < 0)
+    throw std::runtime_error("cannot open " + filename + ": " + std::strerror(errno));
+  struct stat st;
+  if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(header)) {
+    close(fd);
+    throw std::runtime_error(filename + " is not a telemetry file");
+  }
+  length = st.st_size;
+  void* p = mmap(nullptr, length, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (p == MAP_FAILED)
+    throw std::runtime_error("cannot map " + filename + ": " + std::strerror(errno));
+  base = (char*)p;
+  hdr = (const header*)base;
+
+  if (std::memcmp(hdr->magic, MAGIC, sizeof MAGIC) != 0 || hdr->version != VERSION
+      || hdr->ncolumns > (uint32_t)MAX_COLUMNS) {
+    munmap(base, length);
+    throw std::runtime_error(filename + " is not a telemetry file of version " + std::to_string(VERSION));
+  }
+
+  // by name, so that files with columns in another order still read
+  for (uint32_t c = 0; c < hdr->ncolumns; c++) {
+    const column& col = hdr->columns[c];
+    for (int i = 0; i < NFIELDS; i++) {
+      if (std::strncmp(col.name, FIELDS[i].name, sizeof col.name) == 0
+          && col.type == (uint32_t)FIELDS[i].type
+          && col.offset + hdr->capacity * col.size <= length)
+        cols[i] = base + col.offset;
+    }
+  }
+}
+
+telemetry_file::~telemetry_file()
+{
+  munmap(base, length);
+}
+
+telemetry_row telemetry_file::row(uint64_t r) const
+{
+  telemetry_row row;
+  char* dst = (char*)&row;
+  for (int i = 0; i < NFIELDS; i++) {
+    size_t size = type_size(FIELDS[i].type);
+    if (cols[i]) {
+      std::memcpy(dst + FIELDS[i].offset, cols[i] + r * size, size);
+    } else if (FIELDS[i].type == DOUBLE) {
+      double nan = NAN;
+      std::memcpy(dst + FIELDS[i].offset, &nan, size);
+    } else {
+      int32_t none = -1;
+      std::memcpy(dst + FIELDS[i].offset, &none, size);
+    }
+  }
+  return row;
+}
@@ -0,0 +1,90 @@
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <cstdint>
+#include <string>
+
+// one car on one tick. the player fields are only filled for our own car;
+// nticks is -1 and the doubles NaN for the others
+struct telemetry_row {
+  int32_t tick, car, piece, startLane, endLane, lap;
+  double inPieceDistance, angle;
+  // what the old stderr dump had for our car
+  int32_t nticks;
+  double tottravel, speed, angspeed, throttle;
+  double turbofactor; // on the throttle, 1 without turbo
+};
+
+// the file is a header and then each column as one array of capacity
+// values, mapped in full, so appending a row is a store per column and the
+// kernel writes the pages out. unused space stays sparse on disk.
+namespace telemetry {
+
+const char MAGIC[8] = { 'H', 'W', 'O', 'T', 'L', 'M', 0, 0 };
+const uint32_t VERSION = 1;
+enum col_type { INT32 = 0, DOUBLE = 1 };
+
+struct column {
+  char name[16];
+  uint32_t type;
+  uint32_t size; // bytes per value
+  uint64_t offset; // from the start of the file
+};
+
+const int MAX_COLUMNS = 16;
+
+struct header {
+  char magic[8];
+  uint32_t version;
+  uint32_t ncolumns;
+  uint64_t capacity;
+  uint64_t rows; // updated on every append
+  column columns[MAX_COLUMNS];
+};
+
+}
+
+class telemetry_recorder
+{
+public:
+  // rows beyond capacity are counted but not stored
+  telemetry_recorder(const std::string& filename, uint64_t capacity = 1 << 20);
+  ~telemetry_recorder();
+
+  bool ok() const { return base != nullptr; }
+  uint64_t dropped() const { return ndropped; }
+
+  void append(const telemetry_row& row);
+
+private:
+  telemetry_recorder(const telemetry_recorder&);
+  telemetry_recorder& operator=(const telemetry_recorder&);
+
+  char* base;
+  size_t length;
+  telemetry::header* hdr;
+  char* cols[telemetry::MAX_COLUMNS]; // where each column starts
+  uint64_t ndropped;
+};
+
+// read side for the converter
+class telemetry_file
+{
+public:
+  explicit telemetry_file(const std::string& filename);
+  ~telemetry_file();
+
+  uint64_t rows() const { return hdr->rows < hdr->capacity ? hdr->rows : hdr->capacity; }
+  telemetry_row row(uint64_t i) const;
+
+private:
+  telemetry_file(const telemetry_file&);
+  telemetry_file& operator=(const telemetry_file&);
+
+  char* base;
+  size_t length;
+  const telemetry::header* hdr;
+  const char* cols[telemetry::MAX_COLUMNS]; // by the row field, null if missing
+};
+
+#endif
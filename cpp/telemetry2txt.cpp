@@ -0,0 +1,48 @@
+#include <iostream>
+#include <string>
+#include "telemetry.h"
+
+int main(int argc, const char* argv[])
+{
+  if (argc < 2 || argc > 3 || (argc == 3 && std::string(argv[2]) != "csv"))
+  {
+    std::cerr << "Usage: ./telemetry2txt telemetryfile [csv]" << std::endl;
+    std::cerr << "without csv prints our car in the old stderr columns for plotlog.gnuplot:" << std::endl;
+    std::cerr << "nticks tottravel speed pieceIndex angle angspeed throttle" << std::endl;
+    return 1;
+  }
+
+  try
+  {
+    telemetry_file file(argv[1]);
+    bool csv = argc == 3;
+
+    if (csv)
+      std::cout << "tick,car,piece,startLane,endLane,lap,inPieceDistance,angle,nticks,tottravel,speed,angspeed,throttle,turbofactor\n";
+    for (uint64_t i = 0; i < file.rows(); i++) {
+      telemetry_row r = file.row(i);
+      if (csv) {
+        std::cout << r.tick << "," << r.car << "," << r.piece
+          << "," << r.startLane << "," << r.endLane << "," << r.lap
+          << "," << r.inPieceDistance << "," << r.angle
+          << "," << r.nticks << "," << r.tottravel << "," << r.speed
+          << "," << r.angspeed << "," << r.throttle << "," << r.turbofactor << "\n";
+      } else if (r.nticks >= 0) {
+        std::cout << r.nticks
+          << " " << r.tottravel
+          << " " << r.speed
+          << " " << r.piece
+          << " " << r.angle
+          << " " << r.angspeed
+          << " " << r.throttle << "\n";
+      }
+    }
+  }
+  catch (const std::exception& e)
+  {
+    std::cerr << e.what() << std::endl;
+    return 2;
+  }
+
+  return 0;
+}
@@ -1,11 +1,72 @@
 #include "game_objs.h"
+#include "track_index.h"
+#include "velocity_profile.h"
+#include "race_sim.h"
+#include "protocol.h"
+#include "positions_decoder.h"
+#include "logger.h"
+#include "telemetry.h"
+#include "latency.h"
+#include "rawlog.h"
+#include "work_pool.h"
+#include "game_logic.h"
+#include "coef_estimator.h"
+#include "track_cache.h"
+#include <cstdio>
+#include <sstream>
+#include <cstring>
+#include <cmath>
+#include <random>
+#include <map>
+#include <functional>
+#include <chrono>
 #include <iostream>
+#include <fstream>
+#include <cstdlib>
+#include <unistd.h>
+#include <new>
+#include <atomic>
 
 using namespace std;
 using namespace jsoncons;
 
+// every allocation of the process counted, with its size kept in front of
+// it so that what is still live can be told
+namespace {
+  size_t allocations = 0, live_bytes = 0;
+  const size_t ALLOC_HEADER = 16;
+}
+
+// a check that fails the run; the rest of the output is for reading
+int failures = 0;
+
+void expect(bool ok, const string& what) {
+  if (!ok) {
+    cout << "FAILED: " << what << endl;
+    failures++;
+  }
+}
+
+void* operator new(size_t size) {
+  char* p = (char*)malloc(size + ALLOC_HEADER);
+  if (!p)
+    throw bad_alloc();
+  *(size_t*)p = size;
+  allocations++;
+  live_bytes += size;
+  return p + ALLOC_HEADER;
+}
+
+void operator delete(void* p) noexcept {
+  if (!p)
+    return;
+  char* base = (char*)p - ALLOC_HEADER;
+  live_bytes -= *(size_t*)base;
+  free(base);
+}
+
 void obj_parse_test() {
-  string src("{\"track\":{\"pieces\":[{\"length\":100.0,\"switch\":true},{\"radius\":200,\"angle\":22.5}],\"lanes\":[{\"index\":0}]}}");
+  string src("{\"track\":{\"pieces\":[{\"length\":100.0,\"switch\":true},{\"radius\":200,\"angle\":22.5}],\"lanes\":[{\"index\":0,\"distanceFromCenter\":0}]}}");
   json j(json::parse_string(src));
   cout << j << endl;
 
@@ -18,7 +79,7 @@ void obj_parse_test() {
   Track tr = j["track"].as<Track>();
   for (auto x: tr.track)
     cout << x << endl;
-  cout << tr.lanes << endl;
+  cout << tr.nlanes << endl;
 }
 
 void keimola_dump() {
@@ -33,9 +94,917 @@ void keimola_dump() {
   cout << "lane lenghts " << totlen1 << " and " << totlen2 << endl;
 }
 
+void track_index_test() {
+  Track kei = json::parse_file("keimola.json").as<Track>();
+  TrackIndex idx(kei);
+  int n = kei.track.size();
+  double maxerr = 0.0;
+  for (int lane = 0; lane < kei.nlanes; lane++) {
+    for (int from = 0; from < n; from++) {
+      for (int to = 0; to < n; to++) {
+        // piecewise walk like the old Player::dist_to_piece
+        double walk = 0.0;
+        if (from != to) {
+          walk = kei.track[from].travel(kei.lanedist[lane]) - 5.0;
+          for (int i = (from + 1) % n; i != to; i = (i + 1) % n)
+            walk += kei.track[i].travel(kei.lanedist[lane]);
+        }
+        maxerr = max(maxerr, abs(walk - idx.dist_to_piece(lane, from, 5.0, to)));
+      }
+    }
+    cout << "lane " << lane << " lap " << idx.laplength(lane) << endl;
+  }
+  cout << "switches";
+  for (int s: idx.switches)
+    cout << " " << s;
+  cout << endl << "max dist error vs walk " << maxerr << endl;
+}
+
+void velocity_profile_test() {
+  Track kei = json::parse_file("keimola.json").as<Track>();
+  TrackIndex idx(kei);
+  vector<double> limits(idx.npieces);
+  for (int i = 0; i < idx.npieces; i++)
+    limits[i] = idx.bend[i] ? 0.62 * sqrt(idx.radius[i]) : INFINITY;
+
+  VelocityProfile prof;
+  prof.build(&idx, 0.98, limits);
+  for (int p = 0; p < idx.npieces; p++)
+    cout << "piece " << p << " entry speed " << prof.speed_at(0, idx.position(0, p, 0.0)) << endl;
+
+  // incremental update must end up where a full rebuild does
+  limits[4] = 5.0;
+  limits[14] = 9.0;
+  VelocityProfile full;
+  full.build(&idx, 0.98, limits);
+  prof.set_limit(4, 5.0);
+  prof.set_limit(14, 9.0);
+  double maxdiff = 0.0;
+  for (size_t i = 0; i < full.speed.size(); i++)
+    maxdiff = max(maxdiff, abs(full.speed[i] - prof.speed[i]));
+  cout << "incremental vs full max diff " << maxdiff << endl;
+}
+
+void race_sim_test() {
+  sim_config cfg;
+  cfg.laps = 1;
+  race_sim sim(race_sim::load_track("keimola.json"), cfg);
+  sim.add_car("test", "red");
+  sim.start();
+
+  // full throttle from standstill: v1 = p, v2 = d*p + p, like Player assumes
+  sim.apply(0, hwo_protocol::make_throttle(1.0, 0));
+  sim.step();
+  double v1 = sim.car(0).inPieceDistance;
+  sim.step();
+  double v2 = sim.car(0).inPieceDistance - v1;
+  cout << "sim power " << v1 << " drag " << (v2 - v1) / v1 << endl;
+
+  while (!sim.finished())
+    sim.step();
+  cout << "full throttle lap: ticks " << sim.tick() << " crashes " << sim.car(0).crashes << endl;
+}
+
+bool same_position(const CarPosition& a, const CarPosition& b) {
+  return strcmp(a.name, b.name) == 0 && strcmp(a.color, b.color) == 0
+    && a.angle == b.angle && a.pieceIndex == b.pieceIndex
+    && a.inPieceDistance == b.inPieceDistance
+    && a.startLane == b.startLane && a.endLane == b.endLane && a.lap == b.lap;
+}
+
+void positions_decoder_test() {
+  // every message of a two-car race through both the decoder and the dom
+  sim_config cfg;
+  cfg.laps = 1;
+  race_sim sim(race_sim::load_track("keimola.json"), cfg);
+  sim.add_car("first", "red");
+  sim.add_car("a much too long name that does not fit", "blue");
+  positions_decoder dec;
+  int decoded = 0, rejected = 0, mismatches = 0;
+
+  const race_sim::msg_ptrs* msgs = &sim.start();
+  sim.apply(0, hwo_protocol::make_throttle(1.0, 0));
+  sim.apply(1, hwo_protocol::make_throttle(0.6, 0));
+  for (;;) {
+    for (const json* m: *msgs) {
+      string line = m->to_string() + "\n";
+      if (!dec.decode(line)) {
+        rejected++;
+        mismatches += (*m)["msgType"].as<string>() == "carPositions";
+        continue;
+      }
+      decoded++;
+      // the text has rounded doubles, so compare to the same text via dom
+      json dom = json::parse_string(line);
+      const CarPositions& pos = dec.positions();
+      mismatches += pos.tick != dom.get("gameTick", -1).as<int>();
+      mismatches += pos.ncars != 2;
+      for (int i = 0; i < pos.ncars; i++)
+        mismatches += !same_position(pos.cars[i], dom["data"][i].as<CarPosition>());
+    }
+    if (sim.finished())
+      break;
+    msgs = &sim.step();
+  }
+  cout << "decoded " << decoded << " rejected " << rejected << " mismatches " << mismatches << endl;
+
+  // more cars than fit goes to the dom instead
+  json many = *sim.start()[1];
+  json car = many["data"][0];
+  for (int i = 0; i < CarPositions::MAX_CARS; i++)
+    many["data"].add(car);
+  cout << "too many cars decoded: " << dec.decode(many.to_string()) << endl;
+}
+
+bool same_track(const Track& a, const Track& b) {
+  if (a.track.size() != b.track.size() || a.nlanes != b.nlanes || a.lanedist != b.lanedist)
+    return false;
+  for (size_t i = 0; i < a.track.size(); i++) {
+    const Piece& p = a.track[i];
+    const Piece& q = b.track[i];
+    if (p.length != q.length || p.radius != q.radius || p.angle != q.angle || p.switch_ != q.switch_)
+      return false;
+  }
+  return true;
+}
+
+void struct_decoder_test() {
+  // a gameInit and a bare track, each straight from the text and via the dom
+  ifstream in("cpp/gameinit.json");
+  stringstream text;
+  text << in.rdbuf();
+  string src = text.str();
+  struct_decoder<GameInit> init_decoder;
+  GameInit init;
+  bool decoded = init_decoder.decode(src, init);
+  json dom = json::parse_string(src);
+  const json& cars = dom["data"]["race"]["cars"];
+  bool same = decoded && same_track(init.track, dom["data"]["race"]["track"].as<Track>())
+    && init.cars.size() == cars.size();
+  for (size_t i = 0; same && i < cars.size(); i++)
+    same = cars[i]["id"]["name"].as<string>() == init.cars[i].name
+      && cars[i]["id"]["color"].as<string>() == init.cars[i].color;
+  cout << "gameInit decoded " << decoded << " pieces " << init.track.track.size()
+    << " lanes " << init.track.nlanes << " cars " << init.cars.size() << " same as dom " << same << endl;
+
+  ifstream kin("keimola.json");
+  stringstream ktext;
+  ktext << kin.rdbuf();
+  struct_decoder<Track> track_decoder;
+  Track kei;
+  decoded = track_decoder.decode(ktext.str(), kei);
+  cout << "keimola decoded " << decoded << " same as dom "
+    << same_track(kei, json::parse_file("keimola.json").as<Track>()) << endl;
+
+  // not a gameInit, and a gameInit whose track has no pieces
+  cout << "carPositions as gameInit " << init_decoder.decode(string("{\"msgType\":\"carPositions\",\"data\":[]}"), init)
+    << ", no pieces " << init_decoder.decode(string("{\"msgType\":\"gameInit\",\"data\":{\"race\":{\"track\":{\"lanes\":[]}}}}"), init) << endl;
+
+  // a lane index past the four lanes a Track holds is dropped, not counted,
+  // and one given twice counts once with the last distance
+  string odd = "{\"pieces\":[{\"length\":100.0}],\"lanes\":[{\"index\":0,\"distanceFromCenter\":-10},"
+    "{\"index\":1,\"distanceFromCenter\":10},{\"index\":7,\"distanceFromCenter\":30},"
+    "{\"index\":1,\"distanceFromCenter\":20}]}";
+  struct_decoder<Track> odd_decoder;
+  Track odd_track;
+  bool odd_decoded = odd_decoder.decode(odd, odd_track);
+  Track odd_dom = json::parse_string(odd).as<Track>();
+  cout << "lane out of range: decoded " << odd_decoded << " lanes " << odd_track.nlanes
+    << " dom lanes " << odd_dom.nlanes << " same " << same_track(odd_track, odd_dom) << endl;
+  expect(odd_decoded && odd_track.nlanes == 2 && odd_track.lanedist[1] == 20 && same_track(odd_track, odd_dom),
+    "lane out of range or repeated counted");
+}
+
+void logger_test() {
+  ostringstream os;
+  int sink = logging::add_sink(os);
+  LOG_INFO(sink) << "int " << -3 << " unsigned " << 7u << " double " << 0.125 << " char " << 'x';
+  const char name[16] = "fixed";
+  LOG_INFO(sink) << name << " " << string("string") << " " << logging::text("textual", 4);
+  LOG_INFO(sink) << string(5000, 'y') << 1; // longer than the inline buffer
+  LOG_INFO(sink) << string(1 << 23, 'z'); // does not fit in the ring
+  logging::remove_sink(sink);
+  string out = os.str();
+  size_t ys = out.find('y');
+  cout << "logger output:\n" << out.substr(0, ys)
+    << "long line " << out.find('\n', ys) - ys << " chars" << endl
+    << "dropped " << logging::dropped(sink) << endl;
+}
+
+void telemetry_test() {
+  const char* fn = "telemetry_test.bin";
+  uint64_t dropped;
+  {
+    telemetry_recorder rec(fn, 2);
+    rec.append(telemetry_row { 5, 0, 3, 0, 1, 0, 12.5, -4.25, 7, 100.0, 6.5, 0.5, 0.75, 3.0 });
+    rec.append(telemetry_row { 5, 1, 2, 1, 1, 0, 1.0, 2.0, -1, NAN, NAN, NAN, NAN, NAN });
+    rec.append(telemetry_row { 6, 0, 3, 0, 1, 0, 19.0, -4.0, 8, 106.5, 6.5, 0.25, 0.75, 1.0 }); // over capacity
+    dropped = rec.dropped();
+  }
+  telemetry_file file(fn);
+  cout << "telemetry rows " << file.rows() << " dropped " << dropped << endl;
+  for (uint64_t i = 0; i < file.rows(); i++) {
+    telemetry_row r = file.row(i);
+    cout << r.tick << " " << r.car << " " << r.piece << " " << r.startLane << r.endLane << r.lap
+      << " " << r.inPieceDistance << " " << r.angle << " " << r.nticks << " " << r.tottravel
+      << " " << r.speed << " " << r.angspeed << " " << r.throttle << " " << r.turbofactor << endl;
+  }
+  remove(fn);
+}
+
+void rawlog_test() {
+  const char* fn = "rawlog_test.txt";
+  {
+    ofstream f(fn);
+    f << ">> {\"msgType\":\"join\"}\n"
+      << "<< {\"msgType\":\"yourCar\"}\n"
+      << "not a message\n"
+      << ">> {\"data\":1.0,\"msgType\":\"throttle\"}<<< {\"data\":{\"a\":\"}>>\"},\"msgType\":\"carPositions\"}\n"
+      << "\n"
+      << "<< {}";
+  }
+  rawlog_file log(fn);
+  rawlog_file::entry e;
+  stringstream got;
+  while (log.next(e))
+    got << " " << e.line << (e.sent ? ">" : "<") << string(e.data, e.size);
+  got << " skipped " << log.skipped();
+  cout << "rawlog" << got.str() << endl;
+  expect(got.str() == " 1>{\"msgType\":\"join\"} 2<{\"msgType\":\"yourCar\"}"
+    " 4>{\"data\":1.0,\"msgType\":\"throttle\"} 4<{\"data\":{\"a\":\"}>>\"},\"msgType\":\"carPositions\"}"
+    " 6<{} skipped 1", "rawlog entries");
+  remove(fn);
+}
+
+void work_pool_test() {
+  // uneven jobs so that the threads steal; each must run exactly once
+  const size_t n = 1000;
+  vector<atomic<int>> runs(n);
+  for (auto& r: runs)
+    r = 0;
+  parallel_for(n, 4, [&](size_t i) {
+    volatile double x = 0.0;
+    for (size_t k = 0; k < (i % 97) * 100; k++)
+      x = x + sqrt((double)k);
+    runs[i]++;
+  });
+  int wrong = 0;
+  for (auto& r: runs)
+    wrong += r != 1;
+  string error;
+  try {
+    parallel_for(n, 3, [](size_t i) { if (i == 500) throw runtime_error("job 500"); });
+  } catch (const exception& e) {
+    error = e.what();
+  }
+  player_config config;
+  bool known = config.set("bend_speed", 0.7) && config.set("coef_ticks", 1.4) && !config.set("nonesuch", 1);
+  cout << "work pool: jobs run other than once " << wrong << ", error " << error
+    << ", config " << known << " " << config.get("bend_speed") << " " << config.get("coef_ticks") << endl;
+}
+
+// one race of game against the simulator on keimola, its logging muted
+sim_car sim_race(game_logic& game, const sim_config& cfg) {
+  race_sim sim(race_sim::load_track("keimola.json"), cfg);
+  int me = sim.add_car("test", "red");
+  streambuf* out = cout.rdbuf(nullptr);
+  game.react(sim.your_car(me));
+  const race_sim::msg_ptrs* msgs = &sim.start();
+  for (;;) {
+    for (const json* m: *msgs)
+      for (const hwo_protocol::request& reply: game.react(*m))
+        sim.apply(me, reply);
+    if (sim.finished())
+      break;
+    msgs = &sim.step();
+  }
+  logging::flush();
+  cout.rdbuf(out);
+  cout.clear();
+  return sim.car(me);
+}
+
+void coef_estimator_test() {
+  // a race against the simulator recorded like the bot records one, with a
+  // low crash angle for a few crashes, then our car's telemetry fed back
+  // through the estimator as recorded and with noise on the speeds
+  const char* fn = "coef_test.bin";
+  sim_config cfg;
+  cfg.laps = 2;
+  cfg.crash_angle = 30.0;
+  int crashes;
+  {
+    telemetry_recorder rec(fn);
+    game_logic game;
+    game.set_telemetry(&rec);
+    crashes = sim_race(game, cfg).crashes;
+  }
+  vector<telemetry_row> rows;
+  {
+    telemetry_file file(fn);
+    for (uint64_t i = 0; i < file.rows(); i++)
+      if (file.row(i).nticks > 0)
+        rows.push_back(file.row(i));
+  }
+  remove(fn);
+
+  mt19937 rng(7);
+  normal_distribution<double> noise(0.0, 1e-4);
+  for (double sigma: { 0.0, 1e-4 }) {
+    vector<double> speed;
+    for (const telemetry_row& r: rows)
+      speed.push_back(r.speed + (sigma > 0.0 && r.speed != 0.0 ? noise(rng) : 0.0)); // a crashed car stands still
+    double two_power = 0.0, two_drag = 0.0; // the old fit, from the first two ticks
+    auto feed = [&](CoefEstimator& est, int* converged) {
+      for (size_t k = 1; k < rows.size(); k++) {
+        const telemetry_row& a = rows[k - 1];
+        const telemetry_row& b = rows[k];
+        // like Player: same piece, no switch, moving, the same turbo; the
+        // crashes themselves are left to the residual gate
+        if (a.piece != b.piece || a.startLane != a.endLane || b.startLane != b.endLane
+            || (speed[k - 1] == 0.0 && speed[k] == 0.0) || a.turbofactor != b.turbofactor) {
+          est.skip();
+          continue;
+        }
+        est.add(speed[k - 1], speed[k], a.throttle * a.turbofactor);
+        if (converged && est.accepted == 2) {
+          two_power = est.power;
+          two_drag = est.drag;
+        }
+        if (converged && *converged < 0 && est.ready()
+            && fabs(est.power - cfg.power) < 1e-3 * cfg.power && fabs(est.drag - cfg.drag) < 1e-4)
+          *converged = b.nticks;
+      }
+    };
+    CoefEstimator est;
+    int converged = -1;
+    feed(est, &converged);
+
+    const int ROUNDS = 200;
+    auto t0 = chrono::steady_clock::now();
+    for (int i = 0; i < ROUNDS; i++) {
+      CoefEstimator e;
+      feed(e, nullptr);
+    }
+    double ns = chrono::duration<double, nano>(chrono::steady_clock::now() - t0).count() / ROUNDS / rows.size();
+
+    cout << "coef estimator, speed noise " << sigma << ": " << rows.size() << " ticks, " << crashes << " crashes, "
+      << "accepted " << est.accepted << " rejected " << est.rejected
+      << ", power error " << fabs(est.power - cfg.power) << " drag error " << fabs(est.drag - cfg.drag)
+      << " (two ticks " << fabs(two_power - cfg.power) << " " << fabs(two_drag - cfg.drag) << ")"
+      << ", within 0.1% by tick " << converged << ", " << ns << " ns per tick" << endl;
+    double limit = sigma > 0.0 ? 1e-5 : 1e-9;
+    expect(fabs(est.power - cfg.power) < limit && fabs(est.drag - cfg.drag) < limit,
+      "coef estimator error over " + to_string(limit));
+  }
+
+  // a fit of this race keeps through a spell of ticks it cannot explain,
+  // like a turbo nobody told it of; one restored from a race with other
+  // physics is dropped and fits this race's instead
+  auto drive = [](CoefEstimator& est, double& v, double power, double drag, int ticks, double boost) {
+    for (int k = 0; k < ticks; k++) {
+      double throttle = k % 7 < 3 ? 1.0 : 0.4;
+      double next = drag * v + power * throttle * boost;
+      est.add(v, next, throttle);
+      v = next;
+    }
+  };
+  CoefEstimator own, carried;
+  double v = 0.0;
+  drive(own, v, cfg.power, cfg.drag, 200, 1.0);
+  carried.restore(own.save());
+  drive(own, v, cfg.power, cfg.drag, 50, 3.0);
+  drive(own, v, cfg.power, cfg.drag, 50, 1.0);
+  double w = 0.0;
+  drive(carried, w, 0.3, 0.97, 100, 1.0);
+  cout << "coef estimator restart: own fit after 50 boosted ticks power error " << fabs(own.power - cfg.power)
+    << " accepted " << own.accepted << ", carried fit of other physics power error " << fabs(carried.power - 0.3)
+    << " drag error " << fabs(carried.drag - 0.97) << " accepted " << carried.accepted << endl;
+  expect(fabs(own.power - cfg.power) < 1e-9 && fabs(carried.power - 0.3) < 1e-9 && fabs(carried.drag - 0.97) < 1e-9,
+    "coef estimator restart");
+}
+
+// a directory of the test's own for cache files, away from the one the bot
+// keeps in the working directory
+string scratch_dir() {
+  char dir[] = "/tmp/hwotestXXXXXX";
+  if (!mkdtemp(dir))
+    throw runtime_error("cannot make a scratch directory");
+  return dir;
+}
+
+void track_cache_test() {
+  // two races sharing a cache: the first measures and saves at gameEnd, the
+  // second starts from the saved plan
+  sim_config cfg;
+  cfg.laps = 1;
+  Track track = race_sim::load_track("keimola.json").as<Track>();
+  uint64_t hash = track_hash(track);
+  string dir = scratch_dir();
+  string fn = track_cache_path(dir, hash);
+  vector<int> laps;
+  for (int race = 0; race < 2; race++) {
+    game_logic game;
+    game.set_track_cache(dir);
+    laps.push_back(sim_race(game, cfg).lap_ticks.at(0));
+  }
+
+  TrackIndex index(track);
+  Player cold(&track, &index), warm(&track, &index);
+  bool loaded = load_track_model(fn, hash, warm);
+  // the same as planning for the drag and limits it was built with
+  cold.limits = warm.limits;
+  cold.power = warm.power;
+  cold.drag = warm.profile.drag;
+  cold.plan();
+  bool same = warm.profile.speed == cold.profile.speed && warm.profile.cap == cold.profile.cap
+    && warm.profile.limits == cold.profile.limits && warm.profile.first_piece == cold.profile.first_piece;
+
+  const int ROUNDS = 1000;
+  auto t0 = chrono::steady_clock::now();
+  for (int i = 0; i < ROUNDS; i++) {
+    Player p(&track, &index);
+    load_track_model(fn, hash, p);
+  }
+  double us = chrono::duration<double, micro>(chrono::steady_clock::now() - t0).count() / ROUNDS;
+
+  // another track's hash, and a file cut short
+  Player other(&track, &index);
+  bool wrong_track = load_track_model(fn, hash + 1, other);
+  {
+    ifstream in(fn, ios::binary);
+    string bytes((istreambuf_iterator<char>(in)), istreambuf_iterator<char>());
+    ofstream(fn, ios::binary) << bytes.substr(0, bytes.size() - 8);
+  }
+  bool cut = load_track_model(fn, hash, other);
+  remove(fn.c_str());
+  rmdir(dir.c_str());
+
+  cout << "track cache: lap ticks cold " << laps[0] << " warm " << laps[1]
+    << ", loaded " << loaded << " p=" << warm.power << " d=" << warm.drag << " same plan " << same
+    << ", other track " << wrong_track << ", cut short " << cut << " planned " << other.profile.built()
+    << ", load " << us << " us" << endl;
+  expect(loaded && same && !wrong_track && !cut, "track cache load");
+}
+
+void limit_learning_test() {
+  // bends started too fast: the crashes lower their limits until the laps
+  // are clean, and the second race goes on from the cached limits. without
+  // tightening the car crashes every lap
+  sim_config cfg;
+  cfg.laps = 6;
+  player_config fast;
+  fast.bend_speed = 0.75;
+  Track track = race_sim::load_track("keimola.json").as<Track>();
+  uint64_t hash = track_hash(track);
+  string dir = scratch_dir();
+  string fn = track_cache_path(dir, hash);
+  vector<sim_car> races;
+  for (int race = 0; race < 2; race++) {
+    game_logic game(fast);
+    game.set_track_cache(dir);
+    races.push_back(sim_race(game, cfg));
+  }
+  player_config stubborn = fast;
+  stubborn.crash_tighten = 1.0;
+  game_logic same(stubborn);
+  sim_car unlearned = sim_race(same, cfg);
+
+  TrackIndex index(track);
+  Player seeded(&track, &index, fast), learned(&track, &index, fast);
+  bool loaded = load_track_model(fn, hash, learned);
+  remove(fn.c_str());
+  rmdir(dir.c_str());
+  int lower = 0, crashed = 0;
+  for (int i = 0; i < index.npieces; i++) {
+    lower += learned.limits[i] < seeded.limits[i];
+    crashed += learned.crashed_at[i] != INFINITY;
+  }
+
+  // a bend runs over the pieces turning the same way; one limit changed
+  // gives the same curves as a new plan
+  bool bends = learned.bend_of[3] == -1 && learned.bend_of[4] == 4 && learned.bend_of[8] == 4
+    && learned.bend_of[11] == 11 && learned.bend_of[23] == 19 && learned.bend_of[24] == 24;
+  Player once(&track, &index, fast);
+  once.drag = learned.profile.drag;
+  once.plan();
+  once.set_bend_limit(4, 5.0);
+  Player fresh(&track, &index, fast);
+  fresh.limits = once.limits;
+  fresh.drag = once.drag;
+  fresh.plan();
+  bool incremental = once.profile.speed == fresh.profile.speed;
+
+  cout << "limit learning: crashes " << races[0].crashes << " then " << races[1].crashes
+    << ", without tightening " << unlearned.crashes << ", last laps " << races[0].lap_ticks.back()
+    << " " << races[1].lap_ticks.back() << ", loaded " << loaded << " with " << lower << " pieces lower, "
+    << crashed << " crashed at, bends " << bends << ", incremental same " << incremental << endl;
+  expect(races[1].crashes < races[0].crashes, "limit learning: fewer crashes from the cached limits");
+  expect(loaded && bends && incremental, "limit learning: cache, bends and incremental plan");
+}
+
+void latency_histogram_test() {
+  // 1..1000000 ns uniformly; percentiles are bucket tops, at most ~3% over
+  latency_histogram h;
+  for (uint64_t v = 1; v <= 1000000; v++)
+    h.record(v);
+  double worst = 0.0;
+  for (double p: { 0.5, 0.9, 0.99, 0.999 })
+    worst = max(worst, h.percentile(p) / (p * 1000000) - 1);
+  cout << "histogram count " << h.count() << " max " << h.max()
+    << " p50 " << h.percentile(0.5) << " worst relative error " << worst << endl;
+
+  latency_histogram small;
+  for (uint64_t v: { 3, 3, 3, 40 })
+    small.record(v);
+  cout << "small p50 " << small.percentile(0.5) << " p99 " << small.percentile(0.99) << endl;
+}
+
+void outbox_test() {
+  // the templates against the json tree they stand in for
+  hwo_protocol::outbox out;
+  out.lane_change(-1);
+  out.lane_change(1);
+  out.turbo("Pow \"pow\"\n");
+  out.ping();
+  json same[] = {
+    hwo_protocol::make_lane_change("Left"), hwo_protocol::make_lane_change("Right"),
+    hwo_protocol::make_turbo("Pow \"pow\"\n"), hwo_protocol::make_ping()
+  };
+  int fixed_same = 0;
+  for (size_t i = 0; i < out.size(); i++)
+    fixed_same += out.text().substr(out[i].begin, out[i].end - out[i].begin) == same[i].to_string();
+
+  // throttles: the same text as the serializer, which formats doubles the
+  // same way
+  std::mt19937 rng(1);
+  std::uniform_real_distribution<double> unit(0.0, 1.0);
+  vector<double> values = { 0.0, 1.0, 0.5, 0.65, 1e-5, 123.25, -0.25, NAN };
+  for (int i = 0; i < 10000; i++)
+    values.push_back(unit(rng));
+  int exact = 0, bad = 0;
+  for (size_t i = 0; i < values.size(); i++) {
+    out.clear();
+    out.throttle(values[i], i);
+    string line = out.text();
+    json expect = hwo_protocol::make_throttle(values[i], i);
+    json got = json::parse_string(line);
+    if (line == expect.to_string() + "\n")
+      exact++;
+    else if (got["gameTick"].as<int>() != (int)i || got["msgType"].as<string>() != "throttle"
+        || !(fabs(got["data"].as<double>() - values[i]) <= 1e-15 * fabs(values[i])))
+      bad++;
+  }
+  cout << "outbox: fixed shapes same " << fixed_same << "/4, throttles same text "
+    << exact << ", bad " << bad << " of " << values.size() << endl;
+}
+
+void dispatch_bench() {
+  // the messages of a race against the simulator, their msgType looked up
+  // in the std::map of std::function game_logic used to have and with
+  // parse_msg_type and a switch
+  race_sim sim(race_sim::load_track("keimola.json"), sim_config());
+  game_logic game;
+  int me = sim.add_car("test", "red");
+  vector<json> mix;
+  // the bot logs every tick
+  streambuf* out = cout.rdbuf(nullptr);
+  const race_sim::msg_ptrs* msgs = &sim.start();
+  for (;;) {
+    for (const json* m: *msgs) {
+      mix.push_back(*m);
+      for (const hwo_protocol::request& reply: game.react(*m))
+        sim.apply(me, reply);
+    }
+    if (sim.finished())
+      break;
+    msgs = &sim.step();
+  }
+  logging::flush();
+  cout.rdbuf(out);
+  cout.clear();
+
+  typedef std::function<void(int*, const json&)> action_fun;
+  auto count = [](int* n, const json&) { (*n)++; };
+  const std::map<std::string, action_fun> action_map {
+    { "join", count }, { "gameStart", count }, { "gameInit", count },
+    { "carPositions", count }, { "crash", count }, { "gameEnd", count },
+    { "error", count }, { "yourCar", count }, { "turboAvailable", count },
+    { "turboStart", count }, { "turboEnd", count }
+  };
+
+  // the msgType strings as a decoder sees them
+  vector<string> types;
+  for (const json& m: mix)
+    types.push_back(m["msgType"].as<string>());
+
+  const int ROUNDS = 1000;
+  int map_handled = 0, map_replied = 0;
+  auto t0 = chrono::steady_clock::now();
+  for (int r = 0; r < ROUNDS; r++) {
+    for (size_t i = 0; i < mix.size(); i++) {
+      const string& msg_type = types[i];
+      auto it = action_map.find(msg_type);
+      if (it != action_map.end()) {
+        it->second(&map_handled, mix[i]);
+        if (msg_type != "turboAvailable" && msg_type != "turboStart" && msg_type != "turboEnd")
+          map_replied++;
+      }
+    }
+  }
+  auto t1 = chrono::steady_clock::now();
+  int enum_handled = 0, enum_replied = 0;
+  for (int r = 0; r < ROUNDS; r++) {
+    for (size_t i = 0; i < mix.size(); i++) {
+      hwo_protocol::msg_type type = hwo_protocol::parse_msg_type(types[i].data(), types[i].size());
+      switch (type) {
+      case hwo_protocol::MSG_JOIN: case hwo_protocol::MSG_GAME_START:
+      case hwo_protocol::MSG_GAME_INIT: case hwo_protocol::MSG_CAR_POSITIONS:
+      case hwo_protocol::MSG_CRASH: case hwo_protocol::MSG_GAME_END:
+      case hwo_protocol::MSG_ERROR: case hwo_protocol::MSG_YOUR_CAR:
+      case hwo_protocol::MSG_TURBO_AVAILABLE: case hwo_protocol::MSG_TURBO_START:
+      case hwo_protocol::MSG_TURBO_END:
+        count(&enum_handled, mix[i]);
+        if (hwo_protocol::needs_reply(type))
+          enum_replied++;
+        break;
+      default:
+        break;
+      }
+    }
+  }
+  auto t2 = chrono::steady_clock::now();
+
+  double n = (double)mix.size() * ROUNDS;
+  cout << "dispatch: " << mix.size() << " messages, same handled "
+    << (map_handled == enum_handled && map_replied == enum_replied)
+    << ", map " << chrono::duration<double, nano>(t1 - t0).count() / n
+    << " ns, enum " << chrono::duration<double, nano>(t2 - t1).count() / n << " ns per message" << endl;
+
+  int names_ok = 0;
+  for (int t = hwo_protocol::MSG_JOIN; t < hwo_protocol::MSG_TYPE_COUNT; t++) {
+    const char* name = hwo_protocol::msg_type_name((hwo_protocol::msg_type)t);
+    names_ok += hwo_protocol::parse_msg_type(name, strlen(name)) == t;
+  }
+  cout << "msg types round trip " << names_ok << "/" << hwo_protocol::MSG_TYPE_COUNT - 1
+    << ", unknown " << hwo_protocol::parse_msg_type("carPositionz", 12)
+    << hwo_protocol::parse_msg_type("", 0) << hwo_protocol::parse_msg_type("gameEnds", 8) << endl;
+}
+
+void arena_json_test() {
+  // carpositions.json into the heap and into an arena, the same tree back
+  // and after the first message no new arena blocks
+  ifstream in("cpp/carpositions.json");
+  stringstream text;
+  text << in.rdbuf();
+  string src = text.str();
+
+  json_parser heap_parser;
+  json heap_dom;
+  json_arena arena(4096);
+  basic_json_parser<char, arena_storage<char>> arena_parser;
+  arena_json arena_dom;
+  int same = 0, reacted = 0;
+  size_t blocks = 0;
+  game_logic game;
+  const int ROUNDS = 2000;
+  double heap_ns = 0, arena_ns = 0;
+  {
+    json_arena::scope in_arena(arena);
+    for (int r = 0; r < ROUNDS; r++) {
+      auto t0 = chrono::steady_clock::now();
+      heap_parser.parse(src, heap_dom);
+      auto t1 = chrono::steady_clock::now();
+      arena_parser.parse(src, arena_dom);
+      auto t2 = chrono::steady_clock::now();
+      heap_ns += chrono::duration<double, nano>(t1 - t0).count();
+      arena_ns += chrono::duration<double, nano>(t2 - t1).count();
+      if (r == 0) {
+        same = arena_dom.to_string() == heap_dom.to_string();
+        arena_json your_car;
+        arena_parser.parse("{\"msgType\":\"yourCar\",\"data\":{\"name\":\"a\",\"color\":\"red\"}}", your_car);
+        reacted = game.react(your_car).empty();
+      }
+      arena_json().swap(arena_dom);
+      arena.release();
+      if (r == 0)
+        blocks = arena.blocks();
+    }
+  }
+  // copies made outside of a scope come from the fallback arena
+  arena_json copy = arena_json::parse_string(src);
+  cout << "arena json: same tree " << same << ", react " << reacted
+    << ", blocks " << blocks << " then " << arena.blocks()
+    << ", copy same " << (copy.to_string() == heap_dom.to_string())
+    << ", heap " << heap_ns / ROUNDS / 1e3 << " us, arena " << arena_ns / ROUNDS / 1e3 << " us per parse" << endl;
+}
+
+// value_adapter<CarPosition> as it was, a search of every member by name
+CarPosition car_position_by_search(const json& val) {
+  const auto& id = val["id"];
+  const auto& pos = val["piecePosition"];
+  const auto& name = id["name"].as_string();
+  const auto& color = id["color"].as_string();
+  CarPosition p;
+  copy_name(p.name, name.data(), name.size());
+  copy_name(p.color, color.data(), color.size());
+  p.angle           = val["angle"]                 .as<double>();
+  p.pieceIndex      = pos["pieceIndex"]            .as<int>();
+  p.inPieceDistance = pos["inPieceDistance"]       .as<double>();
+  p.startLane       = pos["lane"]["startLaneIndex"].as<int>();
+  p.endLane         = pos["lane"]["endLaneIndex"]  .as<int>();
+  p.lap             = pos.get("lap", 0)            .as<int>();
+  return p;
+}
+
+void key_path_bench() {
+  // the cars of carpositions.json through both lookups
+  json cars = json::parse_file("cpp/carpositions.json")["data"];
+  int mismatches = 0;
+  for (size_t i = 0; i < cars.size(); i++)
+    mismatches += !same_position(cars[i].as<CarPosition>(), car_position_by_search(cars[i]));
+
+  const int ROUNDS = 200000;
+  double search_sum = 0, cached_sum = 0;
+  auto t0 = chrono::steady_clock::now();
+  for (int r = 0; r < ROUNDS; r++)
+    for (size_t i = 0; i < cars.size(); i++)
+      search_sum += car_position_by_search(cars[i]).angle;
+  auto t1 = chrono::steady_clock::now();
+  for (int r = 0; r < ROUNDS; r++)
+    for (size_t i = 0; i < cars.size(); i++)
+      cached_sum += cars[i].as<CarPosition>().angle;
+  auto t2 = chrono::steady_clock::now();
+
+  // another shape: no lap and a member that moves the others
+  key_path lap { "piecePosition", "lap" }, lane { "piecePosition", "lane", "endLaneIndex" };
+  json other = cars[1];
+  other["piecePosition"].remove_member("lap");
+  other["piecePosition"]["extra"] = 1;
+  int found = (lap.find(cars[0]) != nullptr) + (lap.find(other) == nullptr)
+    + (lane.at(cars[1]).as<int>() == 1) + (lane.at(other).as<int>() == 1) + (lane.at(cars[0]).as<int>() == 0);
+
+  double n = (double)cars.size() * ROUNDS;
+  cout << "key paths: mismatches " << mismatches + (search_sum != cached_sum) << ", other shape " << found << "/5, misses "
+    << lap.misses() << " " << lane.misses() << ", search "
+    << chrono::duration<double, nano>(t1 - t0).count() / n << " ns, cached "
+    << chrono::duration<double, nano>(t2 - t1).count() / n << " ns per car" << endl;
+}
+
+void number_bench() {
+  // the numbers of a carPositions message: distances and angles with all
+  // their digits, parsed and printed by jsoncons against the C library
+  std::mt19937 rng(7);
+  std::uniform_real_distribution<double> dist(-60.0, 100.0);
+  vector<double> values;
+  vector<string> texts;
+  char buf[32];
+  for (int i = 0; i < 1000; i++) {
+    values.push_back(dist(rng));
+    snprintf(buf, sizeof buf, "%.17g", values.back());
+    texts.push_back(buf);
+  }
+
+  const int ROUNDS = 200;
+  int mismatches = 0;
+  double library_sum = 0, sum = 0;
+  auto t0 = chrono::steady_clock::now();
+  for (int r = 0; r < ROUNDS; r++)
+    for (size_t i = 0; i < texts.size(); i++)
+      library_sum += strtod(texts[i].c_str(), nullptr);
+  auto t1 = chrono::steady_clock::now();
+  for (int r = 0; r < ROUNDS; r++)
+    for (size_t i = 0; i < texts.size(); i++)
+      sum += string_to_double(texts[i]);
+  auto t2 = chrono::steady_clock::now();
+  size_t chars = 0;
+  for (int r = 0; r < ROUNDS; r++)
+    for (size_t i = 0; i < values.size(); i++)
+      chars += stream_double_to_string<char>(values[i], 16).size();
+  auto t3 = chrono::steady_clock::now();
+  for (int r = 0; r < ROUNDS; r++)
+    for (size_t i = 0; i < values.size(); i++)
+      chars -= double_to_string<char>(values[i], 16).size();
+  auto t4 = chrono::steady_clock::now();
+  for (int r = 0; r < ROUNDS; r++)
+    for (size_t i = 0; i < values.size(); i++)
+      chars += double_to_string<char>(values[i], 0).size() > 0;
+  auto t5 = chrono::steady_clock::now();
+  for (size_t i = 0; i < values.size(); i++) {
+    mismatches += string_to_double(texts[i]) != values[i];
+    mismatches += double_to_string<char>(values[i], 16) != stream_double_to_string<char>(values[i], 16);
+    mismatches += string_to_double(double_to_string<char>(values[i], 0)) != values[i];
+  }
+
+  double n = (double)values.size() * ROUNDS;
+  cout << "numbers: mismatches " << mismatches + (sum != library_sum) + (chars != n) << ", parse strtod "
+    << chrono::duration<double, nano>(t1 - t0).count() / n << " ns, jsoncons "
+    << chrono::duration<double, nano>(t2 - t1).count() / n << " ns; print 16 digits stream "
+    << chrono::duration<double, nano>(t3 - t2).count() / n << " ns, jsoncons "
+    << chrono::duration<double, nano>(t4 - t3).count() / n << " ns, shortest "
+    << chrono::duration<double, nano>(t5 - t4).count() / n << " ns" << endl;
+}
+
+// the Piece adapter as it was, through basic_json::get with a default
+Piece piece_by_get(const json& val) {
+  return Piece{
+    val.get("length", 0.0).as<double>(),
+    val.get("radius", 0.0).as<double>(),
+    val.get("angle", 0.0).as<double>(),
+    val.get("switch", false).as<bool>()
+  };
+}
+
+void json_view_bench() {
+  // the pieces of keimola.json read both ways, the rounds interleaved
+  json trackjson = json::parse_file("keimola.json");
+  json_view track(trackjson);
+  json_view pieces = track["pieces"];
+  int mismatches = 0;
+  for (size_t i = 0; i < pieces.size(); i++) {
+    Piece a = piece_by_get(trackjson["pieces"][i]), b = pieces[i].as<Piece>();
+    mismatches += a.length != b.length || a.radius != b.radius || a.angle != b.angle || a.switch_ != b.switch_;
+  }
+  // views of the elements, a missing member, defaults and errors
+  vector<json_view> elements = track["lanes"].as<vector<json_view>>();
+  int checks = (elements.size() == 2) + (&elements[1].json() == &trackjson["lanes"][1])
+    + track.get("nosuch").is_null() + (track.get("nosuch", 7) == 7) + (track.get("name", string()) == "Keimola")
+    + track.has_member("lanes") + !track.has_member("lane");
+  try {
+    track["nosuch"];
+  } catch (const json_exception&) {
+    checks++;
+  }
+  size_t n = 0;
+  for (json_view lane: track["lanes"])
+    n += lane["index"].as<int>();
+  checks += n == 1;
+
+  const int ROUNDS = 2000;
+  double get_ns = 0, view_ns = 0, sum = 0;
+  for (int r = 0; r < ROUNDS; r++) {
+    auto t0 = chrono::steady_clock::now();
+    const json& p = trackjson["pieces"];
+    for (size_t i = 0; i < p.size(); i++)
+      sum += piece_by_get(p[i]).radius;
+    auto t1 = chrono::steady_clock::now();
+    for (size_t i = 0; i < pieces.size(); i++)
+      sum -= pieces[i].as<Piece>().radius;
+    auto t2 = chrono::steady_clock::now();
+    get_ns += chrono::duration<double, nano>(t1 - t0).count();
+    view_ns += chrono::duration<double, nano>(t2 - t1).count();
+  }
+  double per = (double)pieces.size() * ROUNDS;
+  cout << "json view: mismatches " << mismatches + (sum != 0) << ", checks " << checks << "/9, piece by get "
+    << get_ns / per << " ns, by view " << view_ns / per << " ns" << endl;
+}
+
+void json_memory_test() {
+  // what a carPositions message costs in the heap: allocations made by a
+  // parse and the bytes its tree holds on to
+  ifstream in("cpp/carpositions.json");
+  stringstream text;
+  text << in.rdbuf();
+  string src = text.str();
+  json_parser parser;
+  json dom;
+  parser.parse(src, dom);
+  json().swap(dom);
+  const int ROUNDS = 100;
+  size_t allocs = 0, bytes = 0;
+  for (int r = 0; r < ROUNDS; r++) {
+    size_t a0 = allocations, b0 = live_bytes;
+    parser.parse(src, dom);
+    allocs += allocations - a0;
+    bytes += live_bytes - b0;
+    json().swap(dom);
+  }
+  cout << "json memory: carPositions parse " << allocs / ROUNDS << " allocations, tree "
+    << bytes / ROUNDS << " bytes" << endl;
+}
 
 int main() {
   obj_parse_test();
   keimola_dump();
-  return 0;
+  track_index_test();
+  velocity_profile_test();
+  race_sim_test();
+  positions_decoder_test();
+  struct_decoder_test();
+  logger_test();
+  telemetry_test();
+  rawlog_test();
+  work_pool_test();
+  coef_estimator_test();
+  track_cache_test();
+  limit_learning_test();
+  latency_histogram_test();
+  outbox_test();
+  dispatch_bench();
+  arena_json_test();
+  key_path_bench();
+  number_bench();
+  json_view_bench();
+  json_memory_test();
+  return failures ? 1 : 0;
 }
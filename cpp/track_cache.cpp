@@ -0,0 +1,195 @@
+#include "track_cache.h"
+#include "logger.h"
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace track_cache;
+
+namespace {
+
+// FNV-1a
+struct hasher {
+  uint64_t h = 14695981039346656037ull;
+
+  void add(const void* p, size_t n)
+  {
+    const unsigned char* b = (const unsigned char*)p;
+    for (size_t i = 0; i < n; i++)
+      h = (h ^ b[i]) * 1099511628211ull;
+  }
+  template <class T>
+  void add(T x) { add(&x, sizeof x); }
+};
+
+uint64_t align(uint64_t at)
+{
+  return (at + 63) & ~uint64_t(63);
+}
+
+// the number of samples VelocityProfile::build gives each lane
+int lane_samples(const TrackIndex& index, int lane, double step)
+{
+  return std::max(1, (int)std::ceil(index.laplength(lane) / step));
+}
+
+}
+
+uint64_t track_hash(const Track& track)
+{
+  hasher h;
+  h.add((uint32_t)track.track.size());
+  for (const Piece& p: track.track) {
+    h.add(p.length);
+    h.add(p.radius);
+    h.add(p.angle);
+    h.add((uint8_t)p.switch_);
+  }
+  int nlanes = std::min(std::max(track.nlanes, 0), (int)track.lanedist.size());
+  h.add((int32_t)nlanes);
+  for (int i = 0; i < nlanes; i++)
+    h.add(track.lanedist[i]);
+  return h.h;
+}
+
+std::string track_cache_path(const std::string& dir, uint64_t hash)
+{
+  char name[32];
+  snprintf(name, sizeof name, "trackcache%016llx.bin", (unsigned long long)hash);
+  return (dir.empty() ? std::string(".") : dir) + "/" + name;
+}
+
+bool save_track_model(const std::string& filename, uint64_t hash, const Player& player)
+{
+  const VelocityProfile& prof = player.profile;
+  if (!prof.built() || !player.coefs.ready())
+    return false;
+
+  header h;
+  std::memset(&h, 0, sizeof h);
+  std::memcpy(h.magic, MAGIC, sizeof MAGIC);
+  h.version = VERSION;
+  h.npieces = prof.limits.size();
+  h.hash = hash;
+  h.nlanes = prof.offset.size() - 1;
+  h.nsamples = prof.speed.size();
+  h.step = prof.step;
+  h.drag = prof.drag;
+  h.coefs = player.coefs.save();
+  h.limits = align(sizeof h);
+  h.crashed_at = align(h.limits + h.npieces * sizeof(double));
+  h.lane_offset = align(h.crashed_at + h.npieces * sizeof(double));
+  h.speed = align(h.lane_offset + (h.nlanes + 1) * sizeof(int32_t));
+  h.cap = align(h.speed + h.nsamples * sizeof(double));
+  h.first_piece = align(h.cap + h.nsamples * sizeof(double));
+  h.length = h.first_piece + h.nsamples * sizeof(int32_t);
+
+  std::vector<char> buf(h.length, 0);
+  std::memcpy(&buf[0], &h, sizeof h);
+  std::memcpy(&buf[h.limits], prof.limits.data(), h.npieces * sizeof(double));
+  std::memcpy(&buf[h.crashed_at], player.crashed_at.data(), h.npieces * sizeof(double));
+  for (uint32_t l = 0; l <= h.nlanes; l++) {
+    int32_t o = prof.offset[l];
+    std::memcpy(&buf[h.lane_offset + l * sizeof o], &o, sizeof o);
+  }
+  std::memcpy(&buf[h.speed], prof.speed.data(), h.nsamples * sizeof(double));
+  std::memcpy(&buf[h.cap], prof.cap.data(), h.nsamples * sizeof(double));
+  for (uint32_t i = 0; i < h.nsamples; i++) {
+    int32_t p = prof.first_piece[i];
+    std::memcpy(&buf[h.first_piece + i * sizeof p], &p, sizeof p);
+  }
+
+  const std::string tmp = filename + ".tmp";
+  int fd = open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  bool ok = fd >= 0 && write(fd, buf.data(), buf.size()) == (ssize_t)buf.size();
+  if (fd >= 0)
+    ok = close(fd) == 0 && ok;
+  if (!ok || rename(tmp.c_str(), filename.c_str()) != 0) {
+    LOG_WARN(logging::OUT) << "track cache: cannot write " << filename << ": " << std::strerror(errno);
+    unlink(tmp.c_str());
+    return false;
+  }
+  return true;
+}
+
+bool load_track_model(const std::string& filename, uint64_t hash, Player& player)
+{
+  const TrackIndex& index = *player.index;
+  int fd = open(filename.c_str(), O_RDONLY);
+  if (fd < 0)
+    return false;
+  struct stat st;
+  if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(header)) {
+    close(fd);
+    return false;
+  }
+  size_t length = st.st_size;
+  void* p = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (p == MAP_FAILED)
+    return false;
+  const char* base = (const char*)p;
+  header h;
+  std::memcpy(&h, base, sizeof h);
+
+  // everything checked before anything is copied, a file of another
+  // version or track or a cut off one is just not there
+  bool ok = std::memcmp(h.magic, MAGIC, sizeof MAGIC) == 0 && h.version == VERSION
+    && h.hash == hash && h.length == length
+    && h.npieces == (uint32_t)index.npieces && h.nlanes == (uint32_t)index.nlanes
+    && h.step > 0.0 && h.drag > 0.0 && h.drag < 1.0
+    && h.limits + h.npieces * sizeof(double) <= length
+    && h.crashed_at + h.npieces * sizeof(double) <= length
+    && h.lane_offset + (h.nlanes + 1) * sizeof(int32_t) <= length
+    && h.speed + h.nsamples * sizeof(double) <= length
+    && h.cap + h.nsamples * sizeof(double) <= length
+    && h.first_piece + h.nsamples * sizeof(int32_t) <= length;
+  std::vector<int> offset(h.nlanes + 1);
+  for (uint32_t l = 0; ok && l <= h.nlanes; l++) {
+    int32_t o;
+    std::memcpy(&o, base + h.lane_offset + l * sizeof o, sizeof o);
+    offset[l] = o;
+    ok = l == 0 ? o == 0 : o - offset[l - 1] == lane_samples(index, l - 1, h.step);
+  }
+  ok = ok && offset[h.nlanes] == (int)h.nsamples;
+  CoefEstimator coefs;
+  if (ok) {
+    coefs.restore(h.coefs);
+    ok = coefs.ready();
+  }
+  if (!ok) {
+    munmap(p, length);
+    return false;
+  }
+
+  VelocityProfile& prof = player.profile;
+  prof.index = &index;
+  prof.drag = h.drag;
+  prof.step = h.step;
+  const double* limits = (const double*)(base + h.limits);
+  prof.limits.assign(limits, limits + h.npieces);
+  const double* crashed_at = (const double*)(base + h.crashed_at);
+  player.crashed_at.assign(crashed_at, crashed_at + h.npieces);
+  prof.offset.swap(offset);
+  const double* speed = (const double*)(base + h.speed);
+  prof.speed.assign(speed, speed + h.nsamples);
+  const double* cap = (const double*)(base + h.cap);
+  prof.cap.assign(cap, cap + h.nsamples);
+  const int32_t* first = (const int32_t*)(base + h.first_piece);
+  prof.first_piece.assign(first, first + h.nsamples);
+  munmap(p, length);
+
+  // the profile was built from the limits learned, which go on from there
+  player.limits = prof.limits;
+  player.coefs = coefs;
+  player.power = coefs.power;
+  player.drag = coefs.drag;
+  return true;
+}
@@ -0,0 +1,59 @@
+#ifndef TRACK_CACHE_H
+#define TRACK_CACHE_H
+
+#include "game_objs.h"
+#include "player.h"
+#include <cstdint>
+#include <string>
+
+// what a Player learned about a track, kept on disk between races so that
+// the next race on it starts with the full plan at tick 0 instead of
+// measuring first: the power and drag fit, the speed limits learned for
+// each piece and the velocity profile built from them.
+//
+// one file per track, named by a hash of its pieces and lanes. the file is
+// a header and then the arrays, each starting on a cache line, so a load is
+// one mmap and a copy of each array.
+namespace track_cache {
+
+const char MAGIC[8] = { 'H', 'W', 'O', 'T', 'R', 'K', 0, 0 };
+const uint32_t VERSION = 2;
+
+struct header {
+  char magic[8];
+  uint32_t version;
+  uint32_t npieces;
+  uint64_t hash; // track_hash of the track
+  uint32_t nlanes;
+  uint32_t nsamples; // of the profile over all lanes
+  double step;
+  double drag; // of the profile
+  CoefEstimator::state coefs;
+  uint64_t limits; // offsets from the start of the file: npieces doubles
+  uint64_t crashed_at; // npieces doubles
+  uint64_t lane_offset; // nlanes + 1 int32
+  uint64_t speed; // nsamples doubles
+  uint64_t cap; // nsamples doubles
+  uint64_t first_piece; // nsamples int32
+  uint64_t length; // of the whole file
+};
+
+}
+
+// the same for tracks that race the same, different otherwise
+uint64_t track_hash(const Track& track);
+
+// the cache file of a track in dir
+std::string track_cache_path(const std::string& dir, uint64_t hash);
+
+// player's fit and plan to filename, replacing it in one rename so that a
+// reader never sees half a file. false if the player has no plan yet or
+// the file cannot be written
+bool save_track_model(const std::string& filename, uint64_t hash, const Player& player);
+
+// a saved model into player, whose track and index are set already.
+// false, leaving player as it was, if there is no file for this track or
+// it does not fit
+bool load_track_model(const std::string& filename, uint64_t hash, Player& player);
+
+#endif
@@ -0,0 +1,38 @@
+#include "track_index.h"
+
+TrackIndex::TrackIndex(const Track& track)
+  : npieces(track.track.size()), nlanes(track.nlanes),
+    cumtravel(nlanes * (npieces + 1)),
+    bend(npieces), radius(npieces),
+    cumbends(npieces + 1),
+    switches(),
+    switch_offset(npieces)
+{
+  for (int lane = 0; lane < nlanes; lane++) {
+    double* cum = &cumtravel[lane * (npieces + 1)];
+    cum[0] = 0.0;
+    for (int i = 0; i < npieces; i++)
+      cum[i + 1] = cum[i] + track.track[i].travel(track.lanedist[lane]);
+  }
+
+  cumbends[0] = 0;
+  for (int i = 0; i < npieces; i++) {
+    const Piece& p = track.track[i];
+    bend[i] = p.length == 0.0;
+    radius[i] = p.radius;
+    cumbends[i + 1] = cumbends[i] + bend[i];
+    if (p.switch_)
+      switches.push_back(i);
+  }
+
+  // walk backwards twice so that the pieces after the last switch see the
+  // first one over the lap end
+  int next = -1;
+  for (int i = 2 * npieces - 1; i >= 0; i--) {
+    int idx = i % npieces;
+    if (track.track[idx].switch_)
+      next = i;
+    if (i < npieces)
+      switch_offset[idx] = next == -1 ? npieces : next - i;
+  }
+}
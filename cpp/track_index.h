@@ -0,0 +1,67 @@
+#ifndef TRACK_INDEX_H
+#define TRACK_INDEX_H
+
+#include "game_objs.h"
+#include <vector>
+
+// flat per-lane lookup tables computed once per race from the track pieces,
+// so that distance queries along the track do not need to walk it
+struct TrackIndex {
+  int npieces, nlanes;
+
+  // lane-major, npieces+1 entries per lane: travel from the lap start to the
+  // start of each piece; the last entry is the lap length on that lane
+  std::vector<double> cumtravel;
+  // per piece; char instead of bool to keep a plain flat array
+  std::vector<char> bend;
+  std::vector<double> radius;
+  // npieces+1 entries: number of bends before each piece
+  std::vector<int> cumbends;
+  // indices of the switch pieces in track order
+  std::vector<int> switches;
+  // per piece: how many pieces forward the next switch is, 0 if this one is.
+  // npieces if there are no switches at all
+  std::vector<int> switch_offset;
+
+  TrackIndex() : npieces(0), nlanes(0) {}
+  explicit TrackIndex(const Track& track);
+
+  double laplength(int lane) const {
+    return cumtravel[lane * (npieces + 1) + npieces];
+  }
+
+  // travel of a single piece along a lane
+  double travel(int lane, int piece) const {
+    const double* cum = &cumtravel[lane * (npieces + 1)];
+    return cum[piece + 1] - cum[piece];
+  }
+
+  // distance from the lap start to a position on the given lane
+  double position(int lane, int piece, double inPieceDistance) const {
+    return cumtravel[lane * (npieces + 1) + piece] + inPieceDistance;
+  }
+
+  // forward distance from a position to the start of target piece, staying
+  // on one lane; 0 if already in the target
+  double dist_to_piece(int lane, int piece, double inPieceDistance, int target) const {
+    if (piece == target)
+      return 0.0;
+    return span(lane, piece, target) - inPieceDistance;
+  }
+
+  // travel from the start of piece "from" to the start of piece "to" going
+  // forward, wrapping over the lap end. from == to is zero, not a full lap
+  double span(int lane, int from, int to) const {
+    const double* cum = &cumtravel[lane * (npieces + 1)];
+    double d = cum[to] - cum[from];
+    return to >= from ? d : d + cum[npieces];
+  }
+
+  // number of bends in [from, to), wrapping like span()
+  int bends_between(int from, int to) const {
+    int n = cumbends[to] - cumbends[from];
+    return to >= from ? n : n + cumbends[npieces];
+  }
+};
+
+#endif
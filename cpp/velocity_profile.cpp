@@ -0,0 +1,104 @@
+#include "velocity_profile.h"
+#include <cmath>
+#include <algorithm>
+
+void VelocityProfile::build(const TrackIndex* index, double drag, const std::vector<double>& limits) {
+  this->index = index;
+  this->drag = drag;
+  this->limits = limits;
+
+  offset.assign(index->nlanes + 1, 0);
+  for (int lane = 0; lane < index->nlanes; lane++) {
+    int n = std::max(1, (int)std::ceil(index->laplength(lane) / step));
+    offset[lane + 1] = offset[lane] + n;
+  }
+
+  int total = offset[index->nlanes];
+  speed.assign(total, INFINITY);
+  cap.assign(total, INFINITY);
+  first_piece.assign(total, 0);
+
+  for (int lane = 0; lane < index->nlanes; lane++) {
+    int n = offset[lane + 1] - offset[lane];
+    int p = 0;
+    for (int i = 0; i < n; i++) {
+      while (p < index->npieces - 1 && index->position(lane, p + 1, 0.0) <= i * step)
+        p++;
+      first_piece[offset[lane] + i] = p;
+    }
+    for (int i = 0; i < n; i++)
+      cap[offset[lane] + i] = sample_cap(lane, offset[lane] + i);
+    // twice around so that the bends early in the lap brake the end of it
+    backward(lane, n - 1, 2 * n, false);
+  }
+}
+
+void VelocityProfile::set_drag(double drag) {
+  this->drag = drag;
+  speed.assign(speed.size(), INFINITY);
+  for (int lane = 0; lane < index->nlanes; lane++) {
+    int n = offset[lane + 1] - offset[lane];
+    backward(lane, n - 1, 2 * n, false);
+  }
+}
+
+void VelocityProfile::set_limit(int piece, double limit) {
+  if (limits[piece] == limit)
+    return;
+  limits[piece] = limit;
+
+  for (int lane = 0; lane < index->nlanes; lane++) {
+    int n = offset[lane + 1] - offset[lane];
+    int first = std::min(n - 1, (int)std::floor(index->position(lane, piece, 0.0) / step));
+    int last = std::min(n - 1, std::max(first, (int)std::ceil(index->position(lane, piece + 1, 0.0) / step) - 1));
+
+    for (int i = first; i <= last; i++)
+      cap[offset[lane] + i] = sample_cap(lane, offset[lane] + i);
+    // the last sample overflows the lap into the first piece
+    if (piece == 0)
+      cap[offset[lane] + n - 1] = sample_cap(lane, offset[lane] + n - 1);
+
+    // the piece itself changed for sure, the braking curve before it only
+    // up to where it meets the old one again
+    backward(lane, last, last - first + 1, false);
+    backward(lane, (first + n - 1) % n, n, true);
+  }
+}
+
+double VelocityProfile::speed_at(int lane, double lappos) const {
+  int n = offset[lane + 1] - offset[lane];
+  double lap = index->laplength(lane);
+  if (lappos >= lap)
+    lappos -= lap;
+  int i = std::min(n - 1, std::max(0, (int)(lappos / step)));
+  return speed[offset[lane] + i];
+}
+
+double VelocityProfile::sample_cap(int lane, int sample) const {
+  double start = (sample - offset[lane]) * step;
+  double end = start + step;
+  int p = first_piece[sample];
+  double c = limits[p];
+  for (int q = p + 1; q < index->npieces && index->position(lane, q, 0.0) < end; q++)
+    c = std::min(c, limits[q]);
+  if (end > index->laplength(lane))
+    c = std::min(c, limits[0]);
+  return c;
+}
+
+void VelocityProfile::backward(int lane, int from, int count, bool stop_when_same) {
+  int n = offset[lane + 1] - offset[lane];
+  double* v = &speed[offset[lane]];
+  const double* c = &cap[offset[lane]];
+  double grow = (1 - drag) * step;
+
+  int i = from;
+  for (int k = 0; k < count; k++) {
+    double next = v[i == n - 1 ? 0 : i + 1];
+    double s = std::min(c[i], next + grow);
+    if (stop_when_same && s == v[i])
+      return;
+    v[i] = s;
+    i = i == 0 ? n - 1 : i - 1;
+  }
+}
@@ -0,0 +1,46 @@
+#ifndef VELOCITY_PROFILE_H
+#define VELOCITY_PROFILE_H
+
+#include "track_index.h"
+#include <vector>
+
+// maximum speed at each point of the lap, per lane, so that every bend ahead
+// can still be braked down to with zero throttle.
+//
+// braking from v to u with v_n+1 = d * v_n covers (v - u) / (1 - d) like
+// Player::brake_travel, so going backwards from a bend the allowed speed
+// grows linearly by (1 - d) per unit of distance.
+struct VelocityProfile {
+  const TrackIndex* index;
+  double drag;
+  double step; // distance between samples
+  std::vector<double> limits; // per piece; infinity for no limit
+
+  // all lanes back to back; lane l starts at offset[l] and has
+  // offset[l+1]-offset[l] samples
+  std::vector<int> offset;
+  std::vector<double> speed;
+  // the sample's own limit before braking, min of the pieces it touches
+  std::vector<double> cap;
+  // the piece that each sample starts in
+  std::vector<int> first_piece;
+
+  VelocityProfile() : index(nullptr), drag(0.0), step(1.0) {}
+
+  bool built() const { return index != nullptr; }
+
+  // full backward pass over the whole lap, for new coefs
+  void build(const TrackIndex* index, double drag, const std::vector<double>& limits);
+  // new braking curves for another drag, keeping the limits
+  void set_drag(double drag);
+  // change one piece's limit and redo only the braking curve before it
+  void set_limit(int piece, double limit);
+
+  double speed_at(int lane, double lappos) const;
+
+private:
+  double sample_cap(int lane, int sample) const;
+  void backward(int lane, int from, int count, bool stop_when_same);
+};
+
+#endif
@@ -0,0 +1,136 @@
+#include "work_pool.h"
+#include <atomic>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// the indices [begin, end) one thread has left. the owner takes from the
+// front, thieves from the back
+struct share {
+  std::mutex lock;
+  size_t begin, end;
+
+  bool take(size_t& i)
+  {
+    std::lock_guard<std::mutex> g(lock);
+    if (begin == end)
+      return false;
+    i = begin++;
+    return true;
+  }
+
+  size_t left()
+  {
+    std::lock_guard<std::mutex> g(lock);
+    return end - begin;
+  }
+};
+
+class pool
+{
+public:
+  pool(size_t n, unsigned nthreads, const std::function<void(size_t)>& job)
+    : shares(new share[nthreads]), nthreads(nthreads), job(job), failed(false)
+  {
+    for (unsigned t = 0; t < nthreads; t++) {
+      shares[t].begin = n * t / nthreads;
+      shares[t].end = n * (t + 1) / nthreads;
+    }
+  }
+
+  void run(unsigned self)
+  {
+    size_t i;
+    while (!failed.load(std::memory_order_relaxed)) {
+      if (!shares[self].take(i) && !steal(self, i))
+        return;
+      try {
+        job(i);
+      } catch (...) {
+        std::lock_guard<std::mutex> g(error_lock);
+        if (!error)
+          error = std::current_exception();
+        failed = true;
+      }
+    }
+  }
+
+  void rethrow()
+  {
+    if (error)
+      std::rethrow_exception(error);
+  }
+
+private:
+  // moves the back half of the largest share to self and takes its first
+  bool steal(unsigned self, size_t& i)
+  {
+    for (;;) {
+      unsigned victim = self;
+      size_t most = 0;
+      for (unsigned t = 0; t < nthreads; t++) {
+        if (t == self)
+          continue;
+        size_t left = shares[t].left();
+        if (left > most) {
+          most = left;
+          victim = t;
+        }
+      }
+      if (most == 0)
+        return false;
+
+      size_t from, to;
+      {
+        std::lock_guard<std::mutex> g(shares[victim].lock);
+        share& v = shares[victim];
+        if (v.begin == v.end)
+          continue; // emptied meanwhile, look again
+        to = v.end;
+        from = v.end - (v.end - v.begin + 1) / 2;
+        v.end = from;
+      }
+      i = from;
+      std::lock_guard<std::mutex> g(shares[self].lock);
+      shares[self].begin = from + 1;
+      shares[self].end = to;
+      return true;
+    }
+  }
+
+  std::unique_ptr<share[]> shares;
+  unsigned nthreads;
+  const std::function<void(size_t)>& job;
+  std::atomic<bool> failed;
+  std::mutex error_lock;
+  std::exception_ptr error;
+};
+
+}
+
+unsigned core_count()
+{
+  unsigned n = std::thread::hardware_concurrency();
+  return n > 0 ? n : 1;
+}
+
+void parallel_for(size_t n, unsigned nthreads, const std::function<void(size_t)>& job)
+{
+  if (nthreads == 0)
+    nthreads = core_count();
+  if (nthreads > n)
+    nthreads = n > 0 ? n : 1;
+
+  pool p(n, nthreads, job);
+  std::vector<std::thread> threads;
+  for (unsigned t = 1; t < nthreads; t++)
+    threads.emplace_back(&pool::run, &p, t);
+  p.run(0);
+  for (std::thread& t: threads)
+    t.join();
+  p.rethrow();
+}
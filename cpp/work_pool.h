@@ -0,0 +1,19 @@
+#ifndef WORK_POOL_H
+#define WORK_POOL_H
+
+#include <cstddef>
+#include <functional>
+
+// runs job(0) .. job(n - 1) on nthreads threads (0 for one per core) and
+// returns when all are done. each thread starts with an equal share of
+// the indices and works through it front to back; a thread that runs out
+// takes the back half of the largest share left, so a few slow jobs do not
+// keep the rest of the cores idle. jobs must not share mutable state. the
+// first exception thrown by a job is rethrown here once the threads have
+// stopped, and no new jobs start after it.
+void parallel_for(size_t n, unsigned nthreads, const std::function<void(size_t)>& job);
+
+// std::thread::hardware_concurrency, at least 1
+unsigned core_count();
+
+#endif